@@ -23,6 +23,14 @@ class Clocked {
   public:
     virtual void tick() = 0;
 
+    /**
+     * @brief    Advances the clock by the given number of cycles without ticking.
+     * @details
+     * Used to skip over idle cycles, i.e., cycles in which ticking would do nothing but increment the clock.
+     *
+     */
+    virtual void fast_forward(Clk_t num_cycles) { m_clk += num_cycles; };
+
   public:
     Clocked() {};
 };
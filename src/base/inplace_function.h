@@ -0,0 +1,123 @@
+#ifndef     RAMULATOR_BASE_INPLACE_FUNCTION_H
+#define     RAMULATOR_BASE_INPLACE_FUNCTION_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Ramulator {
+
+template<typename Signature, size_t Capacity>
+class InplaceFunction;
+
+/**
+ * @brief    A std::function-like callable wrapper that stores the callable inline (i.e., it never allocates).
+ *
+ * @details
+ * The wrapped callable (e.g., a lambda and its captures) must fit into Capacity bytes, which is checked at compile
+ * time. Copying, moving, and destroying go through a single per-type manager function.
+ */
+template<typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+  private:
+    enum class Op { Copy, Move, Destroy };
+
+    using Invoker_t = R(*)(void* callable, Args... args);
+    using Manager_t = void(*)(Op op, void* dst, void* src);
+
+    alignas(std::max_align_t) unsigned char m_storage[Capacity];
+    Invoker_t m_invoker = nullptr;
+    Manager_t m_manager = nullptr;
+
+  public:
+    InplaceFunction() = default;
+    InplaceFunction(std::nullptr_t) {};
+
+    template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InplaceFunction>>>
+    InplaceFunction(F&& f) {
+      using Callable_t = std::decay_t<F>;
+      static_assert(sizeof(Callable_t) <= Capacity, "The callable does not fit into the inline storage of InplaceFunction!");
+      static_assert(alignof(Callable_t) <= alignof(std::max_align_t), "The callable is over-aligned for InplaceFunction!");
+      static_assert(std::is_invocable_r_v<R, Callable_t&, Args...>, "The callable has an incompatible signature!");
+
+      if constexpr (std::is_constructible_v<bool, const Callable_t&>) {
+        // Keep empty callables (e.g., an empty std::function or a null function pointer) empty
+        if (!static_cast<bool>(f)) {
+          return;
+        }
+      }
+
+      new (m_storage) Callable_t(std::forward<F>(f));
+      m_invoker = [](void* callable, Args... args) -> R {
+        return (*static_cast<Callable_t*>(callable))(std::forward<Args>(args)...);
+      };
+      m_manager = [](Op op, void* dst, void* src) {
+        switch (op) {
+          case Op::Copy:    new (dst) Callable_t(*static_cast<const Callable_t*>(src)); break;
+          case Op::Move:    new (dst) Callable_t(std::move(*static_cast<Callable_t*>(src))); break;
+          case Op::Destroy: static_cast<Callable_t*>(dst)->~Callable_t(); break;
+        }
+      };
+    };
+
+    InplaceFunction(const InplaceFunction& other) {
+      if (other.m_manager) {
+        other.m_manager(Op::Copy, m_storage, const_cast<unsigned char*>(other.m_storage));
+        m_invoker = other.m_invoker;
+        m_manager = other.m_manager;
+      }
+    };
+
+    InplaceFunction(InplaceFunction&& other) noexcept {
+      if (other.m_manager) {
+        other.m_manager(Op::Move, m_storage, other.m_storage);
+        m_invoker = other.m_invoker;
+        m_manager = other.m_manager;
+        other.reset();
+      }
+    };
+
+    InplaceFunction& operator=(const InplaceFunction& other) {
+      if (this != &other) {
+        InplaceFunction copy(other);
+        *this = std::move(copy);
+      }
+      return *this;
+    };
+
+    InplaceFunction& operator=(InplaceFunction&& other) noexcept {
+      if (this != &other) {
+        reset();
+        if (other.m_manager) {
+          other.m_manager(Op::Move, m_storage, other.m_storage);
+          m_invoker = other.m_invoker;
+          m_manager = other.m_manager;
+          other.reset();
+        }
+      }
+      return *this;
+    };
+
+    ~InplaceFunction() { reset(); };
+
+    explicit operator bool() const { return m_invoker != nullptr; };
+
+    R operator()(Args... args) const {
+      return m_invoker(const_cast<unsigned char*>(m_storage), std::forward<Args>(args)...);
+    };
+
+  private:
+    void reset() {
+      if (m_manager) {
+        m_manager(Op::Destroy, m_storage, nullptr);
+      }
+      m_invoker = nullptr;
+      m_manager = nullptr;
+    };
+};
+
+}        // namespace Ramulator
+
+
+#endif   // RAMULATOR_BASE_INPLACE_FUNCTION_H
@@ -2,14 +2,26 @@
 #define     RAMULATOR_BASE_REQUEST_H
 
 #include <vector>
-#include <list>
+#include <algorithm>
 #include <string>
+#include <unordered_map>
 
 #include "base/base.h"
+#include "base/inplace_function.h"
 
 namespace Ramulator {
 
+/**
+ * @brief    A memory request.
+ * @details
+ * The device address vector and the callback are stored inline, so creating and moving a request never allocates.
+ * The memory system and the controllers move requests between their queues instead of copying them.
+ * 
+ */
 struct Request { 
+  // A callback that fits into the inline storage of the request (e.g., a lambda capturing a few pointers)
+  using Callback_t = InplaceFunction<void(Request&), 32>;
+
   Addr_t    addr = -1;
   AddrVec_t addr_vec {};
 
@@ -41,41 +53,422 @@ struct Request {
   int command = -1;          // The command that need to be issued to progress the request
   int final_command = -1;    // The final command that is needed to finish the request
 
+  uint64_t state_version = -1;  // The device state version at which the scheduler last computed command and is_rowhit
+  bool is_rowhit = false;       // Whether command hits in the row buffer (as of state_version)
+
   Clk_t arrive = -1;   // Clock cycle when the request arrive at the memory controller
+  Clk_t issue = -1;    // Clock cycle when the memory controller issues the first command of the request
   Clk_t depart = -1;   // Clock cycle when the request depart the memory controller
 
-  std::function<void(Request&)> callback;
+  Callback_t callback;
 
+  Request() = default;
   Request(Addr_t addr, int type);
-  Request(AddrVec_t addr_vec, int type);
-  Request(Addr_t addr, int type, int source_id, std::function<void(Request&)> callback);
+  Request(const AddrVec_t& addr_vec, int type);
+  Request(Addr_t addr, int type, int source_id, Callback_t callback);
+
+  Request(Request&&) = default;
+  Request& operator=(Request&&) = default;
+  Request(const Request&) = default;
+  Request& operator=(const Request&) = default;
 };
 
 
+/**
+ * @brief    A FIFO-ordered request buffer backed by a preallocated slab of request slots.
+ * @details
+ * The requests live in a slab of slots that are linked by index in arrival order, with removed slots recycled
+ * through a free list. Enqueueing and removing therefore never allocate, and an iterator stays valid until the
+ * request it points to is removed (like std::list).
+ * 
+ * The buffer accepts a new request as long as it holds at most max_size requests, i.e., it can hold up to
+ * max_size + 1 requests.
+ * 
+ * Optionally, the buffer keeps a count of the buffered requests per address (see index_addresses()) and links the
+ * requests of each row group, i.e., the address vector above the row level, into a per-group queue in arrival order
+ * (see index_row_groups()), so that lookups and schedulers do not scan the whole buffer.
+ * 
+ */
 struct ReqBuffer {
-  std::list<Request> buffer;
-  size_t max_size = 32;
+  private:
+    static constexpr int NIL = -1;
+
+    struct Slot {
+      Request request;
+      int prev = NIL;
+      int next = NIL;
+      uint64_t seq = 0;           // Enqueue order of the request
+      int row_group = NIL;        // The row group of the request (if indexed)
+      int group_prev = NIL;       // The neighbours within the row group (if indexed)
+      int group_next = NIL;
+    };
+
+    std::vector<Slot> m_slots;
+    int m_head = NIL;           // The oldest request
+    int m_tail = NIL;           // The youngest request
+    int m_free = NIL;           // The first unused slot (linked through next)
+    size_t m_size = 0;
+    uint64_t m_next_seq = 0;
+
+    struct RowGroupHash {
+      size_t operator()(const AddrVec_t& row_group) const {
+        size_t hash = row_group.size();
+        for (int addr : row_group) {
+          hash = hash * 0x9e3779b97f4a7c15ULL + static_cast<size_t>(addr + 1);
+        }
+        return hash;
+      };
+    };
+
+    bool m_is_addr_indexed = false;
+    std::unordered_map<Addr_t, int> m_addr_counts;    // Number of buffered requests per address (if indexed)
+
+  public:
+    /**
+     * @brief    The requests of one row group, linked in arrival order.
+     * 
+     */
+    struct RowGroup {
+      int head = NIL;
+      int tail = NIL;
+      size_t size = 0;
+      uint64_t num_updates = 0;   // Bumped whenever a request joins or leaves the group
+      int active_idx = NIL;       // Position in the list of non-empty groups
+    };
+
+  private:
+    int m_row_level = -1;                             // The row level if the row groups are indexed, -1 otherwise
+    std::unordered_map<AddrVec_t, int, RowGroupHash> m_row_group_ids;   // Row group id per row group
+    std::vector<RowGroup> m_row_groups;               // Row groups by id (never released)
+    std::vector<int> m_active_row_groups;             // Ids of the non-empty row groups, in no particular order
+
+  public:
+    size_t max_size = 32;
+
+    class iterator {
+      friend struct ReqBuffer;
+      private:
+        ReqBuffer* m_buffer = nullptr;
+        int m_slot = NIL;
+
+      public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type        = Request;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = Request*;
+        using reference         = Request&;
+
+        iterator() = default;
+        iterator(ReqBuffer* buffer, int slot): m_buffer(buffer), m_slot(slot) {};
+
+        Request& operator*() const { return m_buffer->m_slots[m_slot].request; };
+        Request* operator->() const { return &m_buffer->m_slots[m_slot].request; };
+
+        iterator& operator++() { m_slot = m_buffer->m_slots[m_slot].next; return *this; };
+        iterator operator++(int) { iterator it = *this; ++(*this); return it; };
+        iterator& operator--() { m_slot = (m_slot == NIL) ? m_buffer->m_tail : m_buffer->m_slots[m_slot].prev; return *this; };
+        iterator operator--(int) { iterator it = *this; --(*this); return it; };
+
+        bool operator==(const iterator& other) const { return m_slot == other.m_slot && m_buffer == other.m_buffer; };
+        bool operator!=(const iterator& other) const { return !(*this == other); };
+
+        // Whether the iterator points to a request (i.e., it is neither end() nor default-constructed)
+        bool is_valid() const { return m_slot != NIL; };
+    };
+
+    ReqBuffer() { set_max_size(max_size); };
+
+    ReqBuffer(const ReqBuffer&) = delete;
+    ReqBuffer& operator=(const ReqBuffer&) = delete;
+
+    /**
+     * @brief    Sets the depth of the buffer and preallocates its slab. Must be called while the buffer is empty.
+     * 
+     */
+    void set_max_size(size_t size) {
+      if (m_size != 0) {
+        throw std::runtime_error("Cannot resize a non-empty request buffer!");
+      }
+      max_size = size;
+      m_slots.clear();
+      m_head = m_tail = m_free = NIL;
+      reserve_slots(max_size + 1);
+    };
+
+    /**
+     * @brief    Keeps an index of the buffered addresses from now on. Must be called while the buffer is empty.
+     * 
+     */
+    void index_addresses() {
+      if (m_size != 0) {
+        throw std::runtime_error("Cannot index the addresses of a non-empty request buffer!");
+      }
+      m_is_addr_indexed = true;
+      m_addr_counts.reserve(max_size + 1);
+    };
+
+    /**
+     * @brief    Whether the buffer holds a request to the address. Requires index_addresses().
+     * 
+     */
+    bool contains_addr(Addr_t addr) const {
+      return m_addr_counts.find(addr) != m_addr_counts.end();
+    };
+
+    /**
+     * @brief    Keeps an index of the buffered row groups (the address vector levels above row_level) from now on.
+     *           Must be called while the buffer is empty.
+     * 
+     */
+    void index_row_groups(int row_level) {
+      if (m_size != 0) {
+        throw std::runtime_error("Cannot index the row groups of a non-empty request buffer!");
+      }
+      m_row_level = row_level;
+      m_row_group_ids.reserve(max_size + 1);
+    };
+
+    /**
+     * @brief    Whether the buffer holds a request whose address vector matches addr_vec on all levels above the row
+     *           (e.g., a request to the same bank). Requires index_row_groups().
+     * 
+     */
+    bool contains_row_group(const AddrVec_t& addr_vec) const {
+      auto id_it = m_row_group_ids.find(get_row_group_key(addr_vec));
+      return id_it != m_row_group_ids.end() && m_row_groups[id_it->second].size != 0;
+    };
+
+    bool is_row_group_indexed() const { return m_row_level >= 0; };
 
+    /**
+     * @brief    The ids of the row groups that currently hold requests. Requires index_row_groups().
+     * 
+     */
+    const std::vector<int>& get_active_row_groups() const { return m_active_row_groups; };
+    const RowGroup& get_row_group(int group_id) const { return m_row_groups[group_id]; };
+    int get_row_group_id(iterator it) const { return m_slots[it.m_slot].row_group; };
 
-  using iterator = std::list<Request>::iterator;
-  iterator begin() { return buffer.begin(); };
-  iterator end() { return buffer.end(); };
+    /**
+     * @brief    Walks the requests of a row group from the oldest to the youngest. Requires index_row_groups().
+     * 
+     */
+    iterator row_group_begin(int group_id) { return iterator(this, m_row_groups[group_id].head); };
+    iterator row_group_next(iterator it) { return iterator(this, m_slots[it.m_slot].group_next); };
+    iterator row_group_last(int group_id) { return iterator(this, m_row_groups[group_id].tail); };
 
+    /**
+     * @brief    The enqueue order of the request, i.e., a request precedes another one in the buffer iff its
+     *           sequence number is smaller.
+     * 
+     */
+    uint64_t get_seq(iterator it) const { return m_slots[it.m_slot].seq; };
 
-  size_t size() const { return buffer.size(); }
+    iterator begin() { return iterator(this, m_head); };
+    iterator end() { return iterator(this, NIL); };
 
-  bool enqueue(const Request& request) {
-    if (buffer.size() <= max_size) {
-      buffer.push_back(request);
+    size_t size() const { return m_size; }
+
+    // Whether enqueue() would reject a new request
+    bool is_full() const { return m_size > max_size; }
+
+    /**
+     * @brief    Moves the request into the buffer. The request is left untouched if the buffer is full.
+     * 
+     */
+    bool enqueue(Request&& request) {
+      if (m_size > max_size) {
+        return false;
+      }
+      if (m_free == NIL) {
+        // Only happens if max_size was raised without set_max_size()
+        reserve_slots(m_slots.size() + 1);
+      }
+
+      int slot = m_free;
+      m_free = m_slots[slot].next;
+
+      m_slots[slot].request = std::move(request);
+      m_slots[slot].prev = m_tail;
+      m_slots[slot].next = NIL;
+      m_slots[slot].seq = m_next_seq++;
+      if (m_tail != NIL) {
+        m_slots[m_tail].next = slot;
+      } else {
+        m_head = slot;
+      }
+      m_tail = slot;
+      m_size++;
+
+      add_to_indices(slot);
       return true;
-    } else {
-      return false;
     }
-  }
 
-  void remove(iterator it) {
-    buffer.erase(it);
-  }
+    void remove(iterator it) {
+      int slot = it.m_slot;
+      Slot& s = m_slots[slot];
+      remove_from_indices(slot);
+
+      if (s.prev != NIL) {
+        m_slots[s.prev].next = s.next;
+      } else {
+        m_head = s.next;
+      }
+      if (s.next != NIL) {
+        m_slots[s.next].prev = s.prev;
+      } else {
+        m_tail = s.prev;
+      }
+
+      // Drop the callback (and whatever it captured) now rather than when the slot is reused
+      s.request.callback = nullptr;
+      s.prev = NIL;
+      s.next = m_free;
+      m_free = slot;
+      m_size--;
+    }
+
+  private:
+    AddrVec_t get_row_group_key(const AddrVec_t& addr_vec) const {
+      AddrVec_t row_group;
+      row_group.assign(addr_vec.begin(), addr_vec.begin() + m_row_level);
+      return row_group;
+    };
+
+    void add_to_indices(int slot) {
+      Slot& s = m_slots[slot];
+      if (m_is_addr_indexed) {
+        m_addr_counts[s.request.addr]++;
+      }
+      if (m_row_level >= 0) {
+        auto [id_it, is_new] = m_row_group_ids.try_emplace(get_row_group_key(s.request.addr_vec), m_row_groups.size());
+        if (is_new) {
+          m_row_groups.emplace_back();
+        }
+        int group_id = id_it->second;
+        RowGroup& group = m_row_groups[group_id];
+
+        s.row_group = group_id;
+        s.group_prev = group.tail;
+        s.group_next = NIL;
+        if (group.tail != NIL) {
+          m_slots[group.tail].group_next = slot;
+        } else {
+          group.head = slot;
+        }
+        group.tail = slot;
+
+        if (group.size++ == 0) {
+          group.active_idx = m_active_row_groups.size();
+          m_active_row_groups.push_back(group_id);
+        }
+        group.num_updates++;
+      }
+    };
+
+    void remove_from_indices(int slot) {
+      Slot& s = m_slots[slot];
+      if (m_is_addr_indexed) {
+        auto count_it = m_addr_counts.find(s.request.addr);
+        if (--count_it->second == 0) {
+          m_addr_counts.erase(count_it);
+        }
+      }
+      if (m_row_level >= 0) {
+        RowGroup& group = m_row_groups[s.row_group];
+        if (s.group_prev != NIL) {
+          m_slots[s.group_prev].group_next = s.group_next;
+        } else {
+          group.head = s.group_next;
+        }
+        if (s.group_next != NIL) {
+          m_slots[s.group_next].group_prev = s.group_prev;
+        } else {
+          group.tail = s.group_prev;
+        }
+
+        if (--group.size == 0) {
+          // Swap-remove the group from the list of non-empty groups
+          int last_id = m_active_row_groups.back();
+          m_active_row_groups[group.active_idx] = last_id;
+          m_row_groups[last_id].active_idx = group.active_idx;
+          m_active_row_groups.pop_back();
+          group.active_idx = NIL;
+        }
+        group.num_updates++;
+
+        s.row_group = s.group_prev = s.group_next = NIL;
+      }
+    };
+
+    void reserve_slots(size_t num_slots) {
+      for (size_t slot = m_slots.size(); slot < num_slots; slot++) {
+        m_slots.push_back(Slot{Request(), NIL, m_free});
+        m_free = slot;
+      }
+    };
+};
+
+
+/**
+ * @brief    A queue of in-flight requests ordered by their depart clock cycle.
+ * @details
+ * Requests are kept in a binary min-heap on (depart, insertion order), so that requests that depart in the same
+ * cycle complete in the order they were pushed. drain() retires every request that is due, regardless of how many
+ * requests depart in the same cycle.
+ * 
+ */
+struct ReqCompletionQueue {
+  private:
+    struct Entry {
+      Request request;
+      uint64_t seq;
+    };
+
+    std::vector<Entry> m_heap;
+    uint64_t m_next_seq = 0;
+
+    // std::*_heap build a max-heap, so the "larger" entry is the one that departs later
+    static bool departs_later(const Entry& lhs, const Entry& rhs) {
+      if (lhs.request.depart != rhs.request.depart) {
+        return lhs.request.depart > rhs.request.depart;
+      }
+      return lhs.seq > rhs.seq;
+    };
+
+  public:
+    size_t size() const { return m_heap.size(); };
+    bool empty() const { return m_heap.empty(); };
+
+    /**
+     * @brief    The earliest depart clock cycle among the queued requests. The queue must not be empty.
+     * 
+     */
+    Clk_t next_depart() const { return m_heap.front().request.depart; };
+
+    /**
+     * @brief    Moves the request into the queue. Its depart clock cycle must be set already.
+     * 
+     */
+    void push(Request&& request) {
+      m_heap.push_back(Entry{std::move(request), m_next_seq++});
+      std::push_heap(m_heap.begin(), m_heap.end(), departs_later);
+    };
+
+    /**
+     * @brief    Moves all requests that depart at or before clk into batch (in depart order).
+     * 
+     * @return   The number of retired requests.
+     */
+    size_t drain(Clk_t clk, std::vector<Request>& batch) {
+      size_t num_retired = 0;
+      while (!m_heap.empty() && m_heap.front().request.depart <= clk) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), departs_later);
+        batch.push_back(std::move(m_heap.back().request));
+        m_heap.pop_back();
+        num_retired++;
+      }
+      return num_retired;
+    };
 };
 
 }        // namespace Ramulator
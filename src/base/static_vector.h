@@ -0,0 +1,109 @@
+#ifndef     RAMULATOR_BASE_STATIC_VECTOR_H
+#define     RAMULATOR_BASE_STATIC_VECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <vector>
+
+namespace Ramulator {
+
+/**
+ * @brief    A vector with a fixed capacity whose elements are stored inline (i.e., it never allocates).
+ *
+ * @details
+ * Provides the subset of the std::vector interface that is used for short, bounded sequences such as device
+ * address vectors. Copying or moving a StaticVector copies its elements. Growing it beyond its capacity throws.
+ */
+template<typename T, size_t N>
+class StaticVector {
+  private:
+    T m_data[N] {};
+    size_t m_size = 0;
+
+  public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    StaticVector() = default;
+
+    StaticVector(size_t size, const T& value) {
+      resize(size, value);
+    };
+
+    StaticVector(std::initializer_list<T> values) {
+      assign(values.begin(), values.end());
+    };
+
+    StaticVector(const std::vector<T>& values) {
+      assign(values.begin(), values.end());
+    };
+
+    static constexpr size_t capacity() { return N; };
+
+    size_t size() const { return m_size; };
+    bool empty() const { return m_size == 0; };
+
+    T* data() { return m_data; };
+    const T* data() const { return m_data; };
+
+    iterator begin() { return m_data; };
+    iterator end() { return m_data + m_size; };
+    const_iterator begin() const { return m_data; };
+    const_iterator end() const { return m_data + m_size; };
+
+    T& operator[](size_t i) { return m_data[i]; };
+    const T& operator[](size_t i) const { return m_data[i]; };
+
+    T& front() { return m_data[0]; };
+    const T& front() const { return m_data[0]; };
+    T& back() { return m_data[m_size - 1]; };
+    const T& back() const { return m_data[m_size - 1]; };
+
+    void clear() { m_size = 0; };
+
+    void push_back(const T& value) {
+      check_size(m_size + 1);
+      m_data[m_size++] = value;
+    };
+
+    void pop_back() { m_size--; };
+
+    void resize(size_t size, const T& value = T()) {
+      check_size(size);
+      for (size_t i = m_size; i < size; i++) {
+        m_data[i] = value;
+      }
+      m_size = size;
+    };
+
+    template<typename InputIt>
+    void assign(InputIt first, InputIt last) {
+      m_size = 0;
+      for (; first != last; ++first) {
+        push_back(*first);
+      }
+    };
+
+    friend bool operator==(const StaticVector& lhs, const StaticVector& rhs) {
+      return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    };
+
+    friend bool operator<(const StaticVector& lhs, const StaticVector& rhs) {
+      return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    };
+
+  private:
+    void check_size(size_t size) const {
+      if (size > N) {
+        throw std::length_error("StaticVector capacity exceeded!");
+      }
+    };
+};
+
+}        // namespace Ramulator
+
+
+#endif   // RAMULATOR_BASE_STATIC_VECTOR_H
@@ -6,12 +6,17 @@
 #include <string>
 #include <type_traits>
 
+#include "base/static_vector.h"
+
 
 namespace Ramulator {
 
 using Clk_t     = int64_t;            // Clock cycle
 using Addr_t    = int64_t;            // Plain address as seen by the OS
-using AddrVec_t = std::vector<int>;   // Device address vector as is sent to the device from the controller
+
+// The maximum number of levels in the organization hierarchy of a DRAM device (e.g., channel, ..., row, column)
+inline constexpr size_t MAX_ADDR_LEVELS = 8;
+using AddrVec_t = StaticVector<int, MAX_ADDR_LEVELS>;   // Device address vector as is sent to the device from the controller
 
 template<typename T>
 using Registry_t = std::unordered_map<std::string, T>;
@@ -0,0 +1,103 @@
+#ifndef     RAMULATOR_BASE_WORKER_POOL_H
+#define     RAMULATOR_BASE_WORKER_POOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace Ramulator {
+
+/**
+ * @brief    A persistent pool of worker threads that run the same job in lockstep.
+ *
+ * @details
+ * Each call to run() executes job(worker_id) once on every worker and returns after all of them
+ * have finished, i.e., it acts as a barrier. The calling thread participates as worker 0, so a pool
+ * of N workers only spawns N-1 threads. Workers spin briefly between rounds (rounds are typically
+ * one simulated cycle apart) and fall back to sleeping when the pool is idle for longer.
+ *
+ * The job must partition its work by worker_id such that different workers never touch shared
+ * mutable state. Under this condition the results are independent of the thread interleaving.
+ */
+class WorkerPool {
+  public:
+    using Job_t = std::function<void(int worker_id)>;
+
+  private:
+    static constexpr int SPIN_ITERATIONS = 4096;
+
+    Job_t m_job;
+    std::vector<std::thread> m_threads;
+
+    std::atomic<uint64_t> m_round = 0;      // Incremented by run() to start a new round
+    std::atomic<int>      m_num_done = 0;   // Number of spawned workers that finished the current round
+    std::atomic<bool>     m_stop = false;
+
+  public:
+    WorkerPool(int num_workers, Job_t job) : m_job(std::move(job)) {
+      for (int worker_id = 1; worker_id < num_workers; worker_id++) {
+        m_threads.emplace_back([this, worker_id] { worker_loop(worker_id); });
+      }
+    };
+
+    ~WorkerPool() {
+      m_stop.store(true, std::memory_order_relaxed);
+      m_round.fetch_add(1, std::memory_order_release);
+      m_round.notify_all();
+      for (auto& thread : m_threads) {
+        thread.join();
+      }
+    };
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int get_num_workers() const { return m_threads.size() + 1; };
+
+    /**
+     * @brief    Runs one round of the job on all workers and waits for all of them to finish.
+     *
+     */
+    void run() {
+      m_num_done.store(0, std::memory_order_relaxed);
+      m_round.fetch_add(1, std::memory_order_release);
+      m_round.notify_all();
+
+      m_job(0);
+
+      int num_spawned = m_threads.size();
+      for (int i = 0; m_num_done.load(std::memory_order_acquire) != num_spawned; i++) {
+        if (i >= SPIN_ITERATIONS) {
+          std::this_thread::yield();
+        }
+      }
+    };
+
+  private:
+    void worker_loop(int worker_id) {
+      uint64_t round = 0;
+      while (true) {
+        // Wait for the next round
+        for (int i = 0; m_round.load(std::memory_order_acquire) == round; i++) {
+          if (i >= SPIN_ITERATIONS) {
+            m_round.wait(round, std::memory_order_acquire);
+          }
+        }
+        round = m_round.load(std::memory_order_acquire);
+
+        if (m_stop.load(std::memory_order_relaxed)) {
+          return;
+        }
+
+        m_job(worker_id);
+        m_num_done.fetch_add(1, std::memory_order_acq_rel);
+      }
+    };
+};
+
+}        // namespace Ramulator
+
+
+#endif   // RAMULATOR_BASE_WORKER_POOL_H
@@ -36,6 +36,23 @@ class IDRAM : public Clocked<IDRAM> {
     SpecDef m_requests;                                     // The definition of all requests supported
     SpecLUT<Command_t> m_request_translations{m_requests};  // A LUT of the final DRAM commands needed by every request
 
+    /**
+     * @brief     Checks whether two commands can be issued in the same cycle.
+     * @details
+     * Two commands can be issued together if the device has separate row and column command buses and one command
+     * is sent over each of them (see DRAMCommandMeta::bus). A negative command id (i.e., no command) never pairs.
+     * 
+     */
+    bool can_issue_concurrently(int first_command, int second_command) {
+      if (first_command < 0 || second_command < 0) {
+        return false;
+      }
+      CommandBus first_bus = m_command_meta(first_command).bus;
+      CommandBus second_bus = m_command_meta(second_command).bus;
+      return (first_bus == CommandBus::Row && second_bus == CommandBus::Column) ||
+             (first_bus == CommandBus::Column && second_bus == CommandBus::Row);
+    };
+
 
   /************************************************
    *                Node States
@@ -88,6 +105,19 @@ class IDRAM : public Clocked<IDRAM> {
      */
     virtual bool check_ready(int command, const AddrVec_t& addr_vec) = 0;
 
+    /**
+     * @brief     Returns the earliest clock cycle at which the device can accept the given command.
+     * @details
+     * Given a command and its address, this function should return the earliest clock cycle at which
+     * check_ready() would return true, assuming no other command is issued in the meantime. This is the
+     * latest ready clock of the command along the path from the channel to the scope of the command. A
+     * value that is not later than the current clock cycle means that the command is ready now.
+     * 
+     * Callers can use it to skip or sort commands by their ready time instead of polling check_ready().
+     *
+     */
+    virtual Clk_t get_ready_clk(int command, const AddrVec_t& addr_vec) = 0;
+
     /**
      * @brief     Checks whether the command will result in a rowbuffer hit
      * @details
@@ -97,6 +127,19 @@ class IDRAM : public Clocked<IDRAM> {
      */
     virtual bool check_rowbuffer_hit(int command, const AddrVec_t& addr_vec) = 0;
 
+    /**
+     * @brief     Returns a version number of the device state that the prerequisite and row hit of a command depend on.
+     * @details
+     * Given a command and its address, this function should return a number that changes whenever a command is issued
+     * that may change the result of get_preq_command() or check_rowbuffer_hit() for the command at this address
+     * (e.g., any command to the same bank or a broadcast to its channel), and stays the same otherwise.
+     * 
+     * Callers can use it to cache the prerequisite command and row hit of a request until the state of its bank changes.
+     * A device whose prerequisites also depend on something else (e.g., the clock) may return a new number on every call.
+     * 
+     */
+    virtual uint64_t get_state_version(int command, const AddrVec_t& addr_vec) = 0;
+
     /**
      * @brief     An universal interface for the host to change DRAM configurations on the fly
      * @details
@@ -107,6 +150,24 @@ class IDRAM : public Clocked<IDRAM> {
      */
     virtual void notify(std::string_view key, uint64_t value) {};
 
+    /**
+     * @brief     Whether the device keeps a separate clock for every channel.
+     * @details
+     * The channels of a device do not share any state. If the device also keeps one clock per channel,
+     * the channels can be simulated decoupled from each other, i.e., each channel may run ahead of or
+     * lag behind the others (see advance_channel_clk()).
+     * 
+     */
+    virtual bool has_channel_clocks() { return false; };
+
+    /**
+     * @brief     Advances the clock of a single channel by the given number of cycles.
+     * 
+     */
+    virtual void advance_channel_clk(int channel_id, Clk_t num_cycles) {
+      throw std::runtime_error("The DRAM device does not support per-channel clocks!");
+    };
+
 
   /************************************************
    *        Interface to Query Device Spec
@@ -52,16 +52,16 @@ class HBM2 : public IDRAM, public Implementation {
 
     inline static const ImplLUT m_command_meta = LUT<DRAMCommandMeta> (
       m_commands, {
-                // open?   close?   access?  refresh?
-        {"ACT",   {true,   false,   false,   false}},
-        {"PRE",   {false,  true,    false,   false}},
-        {"PREA",  {false,  true,    false,   false}},
-        {"RD",    {false,  false,   true,    false}},
-        {"WR",    {false,  false,   true,    false}},
-        {"RDA",   {false,  true,    true,    false}},
-        {"WRA",   {false,  true,    true,    false}},
-        {"REFab", {false,  false,   false,   true }},
-        {"REFsb", {false,  false,   false,   true }},
+                // open?   close?   access?  refresh?  bus?
+        {"ACT",   {true,   false,   false,   false,  CommandBus::Row}},
+        {"PRE",   {false,  true,    false,   false,  CommandBus::Row}},
+        {"PREA",  {false,  true,    false,   false,  CommandBus::Row}},
+        {"RD",    {false,  false,   true,    false,  CommandBus::Column}},
+        {"WR",    {false,  false,   true,    false,  CommandBus::Column}},
+        {"RDA",   {false,  true,    true,    false,  CommandBus::Column}},
+        {"WRA",   {false,  true,    true,    false,  CommandBus::Column}},
+        {"REFab", {false,  false,   false,   true,   CommandBus::Row}},
+        {"REFsb", {false,  false,   false,   true,   CommandBus::Row}},
       }
     );
 
@@ -156,6 +156,16 @@ class HBM2 : public IDRAM, public Implementation {
       return m_channels[channel_id]->check_ready(command, addr_vec, m_clk);
     };
 
+    Clk_t get_ready_clk(int command, const AddrVec_t& addr_vec) override {
+      int channel_id = addr_vec[m_levels["channel"]];
+      return m_channels[channel_id]->get_ready_clk(command, addr_vec);
+    };
+
+    uint64_t get_state_version(int command, const AddrVec_t& addr_vec) override {
+      int channel_id = addr_vec[m_levels["channel"]];
+      return m_channels[channel_id]->get_state_version(command, addr_vec);
+    };
+
     bool check_rowbuffer_hit(int command, const AddrVec_t& addr_vec) override {
       int channel_id = addr_vec[m_levels["channel"]];
       return m_channels[channel_id]->check_rowbuffer_hit(command, addr_vec, m_clk);
@@ -1,3 +1,6 @@
+#include <cassert>
+#include <span>
+
 #include "dram/dram.h"
 #include "dram/lambdas.h"
 
@@ -92,30 +95,30 @@ class HBM3PIM : public IDRAM, public Implementation {
 
     inline static const ImplLUT m_command_meta = LUT<DRAMCommandMeta> (
       m_commands, {
-                // open?   close?   access?  refresh?
+                // open?   close?   access?  refresh?  bus?                 broadcast?
         // DRAM commadns
-        {"ACT",   {true,   false,   false,   false}},
-        {"PRE",   {false,  true,    false,   false}},
-        {"PREA",  {false,  true,    false,   false}},
-        {"PRESB", {false,  true,    false,   false}},
-        {"PREPB", {false,  true,    false,   false}},
-        {"RD",    {false,  false,   true,    false}},
-        {"WR",    {false,  false,   true,    false}},
-        {"REFab", {false,  false,   false,   true }},
-        {"REFsb", {false,  false,   false,   true }},
+        {"ACT",   {true,   false,   false,   false,  CommandBus::Row,     false}},
+        {"PRE",   {false,  true,    false,   false,  CommandBus::Row,     false}},
+        {"PREA",  {false,  true,    false,   false,  CommandBus::Row,     false}},
+        {"PRESB", {false,  true,    false,   false,  CommandBus::Both,    true }},
+        {"PREPB", {false,  true,    false,   false,  CommandBus::Both,    true }},
+        {"RD",    {false,  false,   true,    false,  CommandBus::Column,  false}},
+        {"WR",    {false,  false,   true,    false,  CommandBus::Column,  false}},
+        {"REFab", {false,  false,   false,   true,   CommandBus::Row,     false}},
+        {"REFsb", {false,  false,   false,   true,   CommandBus::Row,     false}},
         // PIM commadns
-        {"ACTAB", {true,   false,   false,   false}},
-        {"ACTSB", {true,   false,   false,   false}},
-        {"ACTPB", {true,   false,   false,   false}},
-        {"MACAB", {false,  false,   true,    false}},
-        {"MACSB", {false,  false,   true,    false}},
-        {"MACPB", {false,  false,   true,    false}},
-        {"WRGB",  {false,  false,   false,   false}},
-        {"MVSB",  {false,  false,   false,   false}},
-        {"MVGB",  {false,  false,   false,   false}},
-        {"SFM",   {false,  false,   false,   false}},
-        {"SETM",  {false,  false,   false,   false}},
-        {"SETH",  {false,  false,   false,   false}}
+        {"ACTAB", {true,   false,   false,   false,  CommandBus::Row,     true }},
+        {"ACTSB", {true,   false,   false,   false,  CommandBus::Row,     true }},
+        {"ACTPB", {true,   false,   false,   false,  CommandBus::Row,     true }},
+        {"MACAB", {false,  false,   true,    false,  CommandBus::Column,  true }},
+        {"MACSB", {false,  false,   true,    false,  CommandBus::Column,  true }},
+        {"MACPB", {false,  false,   true,    false,  CommandBus::Column,  true }},
+        {"WRGB",  {false,  false,   false,   false,  CommandBus::Column,  false}},
+        {"MVSB",  {false,  false,   false,   false,  CommandBus::Column,  false}},
+        {"MVGB",  {false,  false,   false,   false,  CommandBus::Column,  false}},
+        {"SFM",   {false,  false,   false,   false,  CommandBus::Column,  false}},
+        {"SETM",  {false,  false,   false,   false,  CommandBus::Column,  false}},
+        {"SETH",  {false,  false,   false,   false,  CommandBus::Column,  false}}
       }
     );
 
@@ -180,6 +183,85 @@ class HBM3PIM : public IDRAM, public Implementation {
       Node(HBM3PIM* dram, Node* parent, int level, int id) : DRAMNodeBase<HBM3PIM>(dram, parent, level, id) {};
     };
     std::vector<Node*> m_channels;
+    std::vector<Clk_t> m_channel_clks;    // Each channel has its own clock so that the channels can be simulated decoupled
+
+    /**
+     * @brief    Incrementally maintained summary of the open rows in a set of banks.
+     * @details
+     * Counts the open banks and the open banks that have the row opened first since the set was last fully closed.
+     * When the two counts are equal, all open banks share that row, which answers most row-open prerequisites of the
+     * set without scanning it. Otherwise, the caller has to scan the set.
+     */
+    struct RowOpenSummary {
+      enum class Check {
+        AllOpen,          // Every bank has the row open
+        FirstClosed,      // Scanning the set, the first bank without the row open is closed
+        FirstConflict,    // Scanning the set, the first bank without the row open has another row open
+        Unknown,          // The summary is not precise enough, scan the set
+      };
+
+      int num_banks = 0;
+      int num_open = 0;
+      int row = Node::NO_OPEN_ROW;
+      int num_on_row = 0;
+
+      void update(int old_row, int new_row) {
+        if (old_row != Node::NO_OPEN_ROW) {
+          num_open--;
+          if (old_row == row) {
+            num_on_row--;
+          }
+          if (num_open == 0) {
+            // The set is fully closed, so the next opened row starts a fresh summary
+            row = Node::NO_OPEN_ROW;
+            num_on_row = 0;
+          }
+        }
+        if (new_row != Node::NO_OPEN_ROW) {
+          // Only retarget the summary while no bank is open. Otherwise, other open banks might hold the new row
+          // without being counted.
+          if (num_open == 0) {
+            row = new_row;
+          }
+          num_open++;
+          if (new_row == row) {
+            num_on_row++;
+          }
+        }
+        assert(num_open >= 0 && num_on_row >= 0 && num_on_row <= num_open);
+      };
+
+      Check check(int target_row) const {
+        if (num_open == 0) {
+          return Check::FirstClosed;
+        } else if (num_on_row != num_open) {
+          return Check::Unknown;
+        } else if (num_open == num_banks) {
+          return row == target_row ? Check::AllOpen : Check::FirstConflict;
+        } else {
+          // Some banks are closed, which comes first only matters if the open ones have another row open
+          return row == target_row ? Check::FirstClosed : Check::Unknown;
+        }
+      };
+    };
+
+    /**
+     * @brief    The banks targeted by the PIM broadcast commands in one channel, precomputed by create_nodes().
+     * @details
+     * Within each set, the banks are listed in (pseudochannel, rank, bankgroup, bank) order, i.e., the order in which
+     * a nested walk of the channel would visit them.
+     */
+    struct PIMBroadcastTargets {
+      std::vector<Node*> all_banks;     // Every bank in the channel (MACAB/ACTAB)
+      std::vector<Node*> same_banks;    // [bank][pseudochannel, rank, bankgroup]: The same bank in every bankgroup (MACSB/ACTSB)
+      std::vector<Node*> per_banks;     // [rank, bankgroup, bank][pseudochannel]: The same bank in every pseudochannel (MACPB/ACTPB)
+      int num_same_banks = 0;
+      int num_per_banks = 0;
+
+      RowOpenSummary all_banks_summary;
+      std::vector<RowOpenSummary> same_banks_summaries;   // [bank]
+    };
+    std::vector<PIMBroadcastTargets> m_pim_targets;
     
     FuncMatrix<ActionFunc_t<Node>>  m_actions;
     FuncMatrix<PreqFunc_t<Node>>    m_preqs;
@@ -188,8 +270,50 @@ class HBM3PIM : public IDRAM, public Implementation {
 
 
   public:
+    std::span<Node* const> get_all_bank_targets(int channel_id) const {
+      return m_pim_targets[channel_id].all_banks;
+    };
+
+    std::span<Node* const> get_same_bank_targets(int channel_id, int bank_id) const {
+      const PIMBroadcastTargets& targets = m_pim_targets[channel_id];
+      return std::span<Node* const>(targets.same_banks).subspan(bank_id * targets.num_same_banks, targets.num_same_banks);
+    };
+
+    std::span<Node* const> get_per_bank_targets(int channel_id, int rank_id, int bankgroup_id, int bank_id) const {
+      const PIMBroadcastTargets& targets = m_pim_targets[channel_id];
+      int num_bankgroups = m_organization.count[m_levels["bankgroup"]];
+      int num_banks = m_organization.count[m_levels["bank"]];
+      int set_id = (rank_id * num_bankgroups + bankgroup_id) * num_banks + bank_id;
+      return std::span<Node* const>(targets.per_banks).subspan(set_id * targets.num_per_banks, targets.num_per_banks);
+    };
+
+    const RowOpenSummary& get_all_bank_summary(int channel_id) const {
+      return m_pim_targets[channel_id].all_banks_summary;
+    };
+
+    const RowOpenSummary& get_same_bank_summary(int channel_id, int bank_id) const {
+      return m_pim_targets[channel_id].same_banks_summaries[bank_id];
+    };
+
+    void on_open_row_change(Node* bank, int old_row, int new_row) {
+      Node* channel = bank->m_parent_node->m_parent_node->m_parent_node->m_parent_node;
+      PIMBroadcastTargets& targets = m_pim_targets[channel->m_node_id];
+      targets.all_banks_summary.update(old_row, new_row);
+      targets.same_banks_summaries[bank->m_node_id].update(old_row, new_row);
+    };
+
     void tick() override {
       m_clk++;
+      for (auto& clk : m_channel_clks) {
+        clk++;
+      }
+    };
+
+    void fast_forward(Clk_t num_cycles) override {
+      m_clk += num_cycles;
+      for (auto& clk : m_channel_clks) {
+        clk += num_cycles;
+      }
     };
 
     void init() override {
@@ -207,23 +331,41 @@ class HBM3PIM : public IDRAM, public Implementation {
 
     void issue_command(int command, const AddrVec_t& addr_vec) override {
       int channel_id = addr_vec[m_levels["channel"]];
-      m_channels[channel_id]->update_timing(command, addr_vec, m_clk);
-      m_channels[channel_id]->update_states(command, addr_vec, m_clk);
+      m_channels[channel_id]->update_timing(command, addr_vec, m_channel_clks[channel_id]);
+      m_channels[channel_id]->update_states(command, addr_vec, m_channel_clks[channel_id]);
     };
 
     int get_preq_command(int command, const AddrVec_t& addr_vec) override {
       int channel_id = addr_vec[m_levels["channel"]];
-      return m_channels[channel_id]->get_preq_command(command, addr_vec, m_clk);
+      return m_channels[channel_id]->get_preq_command(command, addr_vec, m_channel_clks[channel_id]);
     };
 
     bool check_ready(int command, const AddrVec_t& addr_vec) override {
       int channel_id = addr_vec[m_levels["channel"]];
-      return m_channels[channel_id]->check_ready(command, addr_vec, m_clk);
+      return m_channels[channel_id]->check_ready(command, addr_vec, m_channel_clks[channel_id]);
+    };
+
+    Clk_t get_ready_clk(int command, const AddrVec_t& addr_vec) override {
+      int channel_id = addr_vec[m_levels["channel"]];
+      return m_channels[channel_id]->get_ready_clk(command, addr_vec);
+    };
+
+    uint64_t get_state_version(int command, const AddrVec_t& addr_vec) override {
+      int channel_id = addr_vec[m_levels["channel"]];
+      return m_channels[channel_id]->get_state_version(command, addr_vec);
     };
 
     bool check_rowbuffer_hit(int command, const AddrVec_t& addr_vec) override {
       int channel_id = addr_vec[m_levels["channel"]];
-      return m_channels[channel_id]->check_rowbuffer_hit(command, addr_vec, m_clk);
+      return m_channels[channel_id]->check_rowbuffer_hit(command, addr_vec, m_channel_clks[channel_id]);
+    };
+
+    bool has_channel_clocks() override {
+      return true;
+    };
+
+    void advance_channel_clk(int channel_id, Clk_t num_cycles) override {
+      m_channel_clks[channel_id] += num_cycles;
     };
 
   private:
@@ -574,7 +716,59 @@ class HBM3PIM : public IDRAM, public Implementation {
       for (int i = 0; i < num_channels; i++) {
         Node* channel = new Node(this, nullptr, 0, i);
         m_channels.push_back(channel);
+        m_pim_targets.push_back(create_pim_targets(channel));
       }
+      m_channel_clks.resize(num_channels, 0);
+    };
+
+    PIMBroadcastTargets create_pim_targets(Node* channel) {
+      int num_pseudochannels = m_organization.count[m_levels["pseudochannel"]];
+      int num_ranks = m_organization.count[m_levels["rank"]];
+      int num_bankgroups = m_organization.count[m_levels["bankgroup"]];
+      int num_banks = m_organization.count[m_levels["bank"]];
+
+      PIMBroadcastTargets targets;
+      targets.num_same_banks = num_pseudochannels * num_ranks * num_bankgroups;
+      targets.num_per_banks = num_pseudochannels;
+      targets.all_banks_summary.num_banks = num_pseudochannels * num_ranks * num_bankgroups * num_banks;
+      targets.same_banks_summaries.resize(num_banks);
+      for (auto& summary : targets.same_banks_summaries) {
+        summary.num_banks = targets.num_same_banks;
+      }
+
+      for (auto pch : channel->m_child_nodes) {
+        for (auto rank : pch->m_child_nodes) {
+          for (auto bg : rank->m_child_nodes) {
+            for (auto bank : bg->m_child_nodes) {
+              targets.all_banks.push_back(bank);
+            }
+          }
+        }
+      }
+
+      auto get_bank = [&](int pch, int rank, int bg, int bank) {
+        return targets.all_banks[((pch * num_ranks + rank) * num_bankgroups + bg) * num_banks + bank];
+      };
+      for (int bank = 0; bank < num_banks; bank++) {
+        for (int pch = 0; pch < num_pseudochannels; pch++) {
+          for (int rank = 0; rank < num_ranks; rank++) {
+            for (int bg = 0; bg < num_bankgroups; bg++) {
+              targets.same_banks.push_back(get_bank(pch, rank, bg, bank));
+            }
+          }
+        }
+      }
+      for (int rank = 0; rank < num_ranks; rank++) {
+        for (int bg = 0; bg < num_bankgroups; bg++) {
+          for (int bank = 0; bank < num_banks; bank++) {
+            for (int pch = 0; pch < num_pseudochannels; pch++) {
+              targets.per_banks.push_back(get_bank(pch, rank, bg, bank));
+            }
+          }
+        }
+      }
+
+      return targets;
     };
 };
 
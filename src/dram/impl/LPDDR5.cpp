@@ -132,6 +132,7 @@ class LPDDR5 : public IDRAM, public Implementation {
       Node(LPDDR5* dram, Node* parent, int level, int id) : DRAMNodeBase<LPDDR5>(dram, parent, level, id) {};
     };
     std::vector<Node*> m_channels;
+    uint64_t m_num_state_version_queries = 0;   // Makes every state version unique (see get_state_version())
     
     FuncMatrix<ActionFunc_t<Node>>  m_actions;
     FuncMatrix<PreqFunc_t<Node>>    m_preqs;
@@ -173,6 +174,17 @@ class LPDDR5 : public IDRAM, public Implementation {
       return m_channels[channel_id]->check_ready(command, addr_vec, m_clk);
     };
 
+    Clk_t get_ready_clk(int command, const AddrVec_t& addr_vec) override {
+      int channel_id = addr_vec[m_levels["channel"]];
+      return m_channels[channel_id]->get_ready_clk(command, addr_vec);
+    };
+
+    uint64_t get_state_version(int command, const AddrVec_t& addr_vec) override {
+      // The RD/WR prerequisites also depend on the clock and on CAS commands to the other banks of the rank (see
+      // m_final_synced_cycle), which the node counters do not track. Never let them be cached.
+      return m_num_state_version_queries++;
+    };
+
     bool check_rowbuffer_hit(int command, const AddrVec_t& addr_vec) override {
       int channel_id = addr_vec[m_levels["channel"]];
       return m_channels[channel_id]->check_rowbuffer_hit(command, addr_vec, m_clk);
@@ -414,7 +426,7 @@ class LPDDR5 : public IDRAM, public Implementation {
       // Bank actions
       m_actions[m_levels["bank"]][m_commands["ACT-1"]] = [] (Node* node, int cmd, int target_id, Clk_t clk) {
         node->m_state = m_states["Pre-Opened"];
-        node->m_row_state[target_id] = m_states["Pre-Opened"];
+        node->open_row(target_id, m_states["Pre-Opened"]);
       };
       m_actions[m_levels["bank"]][m_commands["ACT-2"]] = Lambdas::Action::Bank::ACT<LPDDR5>;
       m_actions[m_levels["bank"]][m_commands["PRE"]]   = Lambdas::Action::Bank::PRE<LPDDR5>;
@@ -429,13 +441,13 @@ class LPDDR5 : public IDRAM, public Implementation {
       m_preqs[m_levels["rank"]][m_commands["REFab"]] = Lambdas::Preq::Rank::RequireAllBanksClosed<LPDDR5>;
       m_preqs[m_levels["rank"]][m_commands["RFMab"]] = Lambdas::Preq::Rank::RequireAllBanksClosed<LPDDR5>;
 
-      m_preqs[m_levels["rank"]][m_commands["REFpb"]] = [this] (Node* node, int cmd, int target_id, Clk_t clk) {
+      m_preqs[m_levels["rank"]][m_commands["REFpb"]] = [] (Node* node, int cmd, int target_id, Clk_t clk) {
         int target_bank_id = target_id;
         int another_target_bank_id = target_id + 8;
 
         for (auto bg : node->m_child_nodes) {
           for (auto bank : bg->m_child_nodes) {
-            int num_banks_per_bg = m_organization.count[m_levels["bank"]];
+            int num_banks_per_bg = node->m_spec->m_organization.count[m_levels["bank"]];
             int flat_bankid = bank->m_node_id + bg->m_node_id * num_banks_per_bg;
             if (flat_bankid == target_id || flat_bankid == another_target_bank_id) {
               switch (node->m_state) {
@@ -457,7 +469,7 @@ class LPDDR5 : public IDRAM, public Implementation {
           case m_states["Closed"]: return m_commands["ACT-1"];
           case m_states["Pre-Opened"]: return m_commands["ACT-2"];
           case m_states["Opened"]: {
-            if (node->m_row_state.find(target_id) != node->m_row_state.end()) {
+            if (node->is_row_open(target_id)) {
               Node* rank = node->m_parent_node->m_parent_node;
               if (rank->m_final_synced_cycle < clk) {
                 return m_commands["CASRD"];
@@ -479,7 +491,7 @@ class LPDDR5 : public IDRAM, public Implementation {
           case m_states["Closed"]: return m_commands["ACT-1"];
           case m_states["Pre-Opened"]: return m_commands["ACT-2"];
           case m_states["Opened"]: {
-            if (node->m_row_state.find(target_id) != node->m_row_state.end()) {
+            if (node->is_row_open(target_id)) {
               Node* rank = node->m_parent_node->m_parent_node;
               if (rank->m_final_synced_cycle < clk) {
                 return m_commands["CASWR"];
@@ -16,29 +16,24 @@ namespace Bank {
   template <class T>
   void ACT(typename T::Node* node, int cmd, int target_id, Clk_t clk) {
     node->m_state = T::m_states["Opened"];
-    node->m_row_state[target_id] = T::m_states["Opened"];
+    node->open_row(target_id, T::m_states["Opened"]);
   };
 
   template <class T>
   void PRE(typename T::Node* node, int cmd, int target_id, Clk_t clk) {
     node->m_state = T::m_states["Closed"];
-    node->m_row_state.clear();
+    node->close_rows();
   };
 
+  // The PIM broadcast actions iterate over the target sets precomputed by the spec (see HBM3PIM::create_pim_targets())
   template <class T>
   void ACTAB(typename T::Node* node, int cmd, int target_id, Clk_t clk) {
     // For HBM3
     if constexpr (T::m_levels["bank"] - T::m_levels["channel"] == 4) {
       typename T::Node* channel = node->m_parent_node->m_parent_node->m_parent_node->m_parent_node;
-      for (auto pc : channel->m_child_nodes) {
-        for (auto rank : pc->m_child_nodes) {
-          for (auto bg : rank->m_child_nodes) {
-            for (auto bank : bg->m_child_nodes) {
-              bank->m_state = T::m_states["Opened"];
-              bank->m_row_state[target_id] = T::m_states["Opened"];
-            }
-          }
-        }
+      for (auto bank : node->m_spec->get_all_bank_targets(channel->m_node_id)) {
+        bank->m_state = T::m_states["Opened"];
+        bank->open_row(target_id, T::m_states["Opened"]);
       }
     } else {
       static_assert(
@@ -53,17 +48,9 @@ namespace Bank {
     // For HBM3
     if constexpr (T::m_levels["bank"] - T::m_levels["channel"] == 4) {
       typename T::Node* ch = node->m_parent_node->m_parent_node->m_parent_node->m_parent_node;
-      for (auto pch : ch->m_child_nodes) {
-        for (auto rank : pch->m_child_nodes) {
-          for (auto bg : rank->m_child_nodes) {
-            for (auto bank : bg->m_child_nodes) {
-              if (bank->m_node_id == node->m_node_id) {
-                bank->m_state = T::m_states["Opened"];
-                bank->m_row_state[target_id] = T::m_states["Opened"];
-              }
-            }
-          }
-        }
+      for (auto bank : node->m_spec->get_same_bank_targets(ch->m_node_id, node->m_node_id)) {
+        bank->m_state = T::m_states["Opened"];
+        bank->open_row(target_id, T::m_states["Opened"]);
       }
     } else {
       static_assert(
@@ -78,21 +65,11 @@ namespace Bank {
     // For HBM3
     if constexpr (T::m_levels["bank"] - T::m_levels["channel"] == 4) {
       typename T::Node* ch = node->m_parent_node->m_parent_node->m_parent_node->m_parent_node;
-      for (auto pch : ch->m_child_nodes) {
-        for (auto rank : pch->m_child_nodes) {
-          if (rank->m_node_id == node->m_parent_node->m_parent_node->m_node_id) {
-            for (auto bg : rank->m_child_nodes) {
-              if (bg->m_node_id == node->m_parent_node->m_node_id) {
-                for (auto bank : bg->m_child_nodes) {
-                  if (bank->m_node_id == node->m_node_id) {
-                    bank->m_state = T::m_states["Opened"];
-                    bank->m_row_state[target_id] = T::m_states["Opened"];
-                  }
-                }
-              }
-            }
-          }
-        }
+      typename T::Node* bg = node->m_parent_node;
+      typename T::Node* rank = bg->m_parent_node;
+      for (auto bank : node->m_spec->get_per_bank_targets(ch->m_node_id, rank->m_node_id, bg->m_node_id, node->m_node_id)) {
+        bank->m_state = T::m_states["Opened"];
+        bank->open_row(target_id, T::m_states["Opened"]);
       }
     } else {
       static_assert(
@@ -115,7 +92,7 @@ namespace Bank {
                 for (auto bank : bg->m_child_nodes) {
                   if (bank->m_node_id == node->m_node_id) {
                     bank->m_state = T::m_states["Closed"];
-                    bank->m_row_state.clear();
+                    bank->close_rows();
                   }
                 }
               }
@@ -138,7 +115,7 @@ namespace Bank {
       for (auto bank : bg->m_child_nodes) {
         if (bank->m_node_id == node->m_node_id) {
           bank->m_state = T::m_states["Closed"];
-          bank->m_row_state.clear();
+          bank->close_rows();
         }
       }
     }
@@ -149,21 +126,11 @@ namespace Bank {
     // For HBM3
     if constexpr (T::m_levels["bank"] - T::m_levels["channel"] == 4) {
       typename T::Node* ch = node->m_parent_node->m_parent_node->m_parent_node->m_parent_node;
-      for (auto pch : ch->m_child_nodes) {
-        for (auto rank : pch->m_child_nodes) {
-          if (rank->m_node_id == node->m_parent_node->m_parent_node->m_node_id) {
-            for (auto bg : rank->m_child_nodes) {
-              if (bg->m_node_id == node->m_parent_node->m_node_id) {
-                for (auto bank : bg->m_child_nodes) {
-                  if (bank->m_node_id == node->m_node_id) {
-                    bank->m_state = T::m_states["Closed"];
-                    bank->m_row_state.clear();
-                  }
-                }
-              }
-            }
-          }
-        }
+      typename T::Node* bg = node->m_parent_node;
+      typename T::Node* rank = bg->m_parent_node;
+      for (auto bank : node->m_spec->get_per_bank_targets(ch->m_node_id, rank->m_node_id, bg->m_node_id, node->m_node_id)) {
+        bank->m_state = T::m_states["Closed"];
+        bank->close_rows();
       }
     } else {
       static_assert(
@@ -183,7 +150,7 @@ namespace BankGroup {
       for (auto bank : bg->m_child_nodes) {
         if (bank->m_node_id == target_id) {
           bank->m_state = T::m_states["Closed"];
-          bank->m_row_state.clear();
+          bank->close_rows();
         }
       }
     }
@@ -210,16 +177,8 @@ namespace BankGroup {
     same_bank_addr[T::m_levels["bank"]] = target_id;
 
     typename T::Node* ch = node->m_parent_node->m_parent_node->m_parent_node;
-    for (auto pch : ch->m_child_nodes) {
-      for (auto rank : pch->m_child_nodes) {
-        for (auto bg : rank->m_child_nodes) {
-          for (auto bank : bg->m_child_nodes) {
-            if (bank->m_node_id == target_id) {
-              bank->update_timing(cmd, same_bank_addr, clk);
-            }
-          }
-        }
-      }
+    for (auto bank : node->m_spec->get_same_bank_targets(ch->m_node_id, target_id)) {
+      bank->update_timing(cmd, same_bank_addr, clk);
     }
   }
 
@@ -230,20 +189,9 @@ namespace BankGroup {
     same_bank_addr[T::m_levels["bank"]] = target_id;
 
     typename T::Node* ch = node->m_parent_node->m_parent_node->m_parent_node;
-    for (auto pch : ch->m_child_nodes) {
-      for (auto rank : pch->m_child_nodes) {
-        if (rank->m_node_id == node->m_parent_node->m_parent_node->m_node_id) {
-          for (auto bg : rank->m_child_nodes) {
-            if (bg->m_node_id == node->m_parent_node->m_node_id) {
-              for (auto bank : bg->m_child_nodes) {
-                if (bank->m_node_id == target_id) {
-                  bank->update_timing(cmd, same_bank_addr, clk);
-                }
-              }
-            }
-          }
-        }
-      }
+    typename T::Node* rank = node->m_parent_node;
+    for (auto bank : node->m_spec->get_per_bank_targets(ch->m_node_id, rank->m_node_id, node->m_node_id, target_id)) {
+      bank->update_timing(cmd, same_bank_addr, clk);
     }
   }
 
@@ -256,13 +204,13 @@ namespace Rank {
     if constexpr (T::m_levels["bank"] - T::m_levels["rank"] == 1) {
       for (auto bank : node->m_child_nodes) {
         bank->m_state = T::m_states["Closed"];
-        bank->m_row_state.clear();
+        bank->close_rows();
       }
     } else if constexpr (T::m_levels["bank"] - T::m_levels["rank"] == 2) {
       for (auto bg : node->m_child_nodes) {
         for (auto bank : bg->m_child_nodes) {
           bank->m_state = T::m_states["Closed"];
-          bank->m_row_state.clear();
+          bank->close_rows();
         }
       }
     } else {
@@ -279,7 +227,7 @@ namespace Rank {
       for (auto bank : bg->m_child_nodes) {
         if (bank->m_node_id == target_id) {
           bank->m_state = T::m_states["Closed"];
-          bank->m_row_state.clear();
+          bank->close_rows();
         }
       }
     }
@@ -295,7 +243,7 @@ namespace Channel {
       for (auto bg : node->m_child_nodes) {
         for (auto bank : bg->m_child_nodes) {
           bank->m_state = T::m_states["Closed"];
-          bank->m_row_state.clear();
+          bank->close_rows();
         }
       }
     } else if constexpr (T::m_levels["bank"] - T::m_levels["channel"] == 3) {
@@ -303,7 +251,7 @@ namespace Channel {
         for (auto bg : pc->m_child_nodes) {
           for (auto bank : bg->m_child_nodes) {
             bank->m_state = T::m_states["Closed"];
-            bank->m_row_state.clear();
+            bank->close_rows();
           }
         }
       }
@@ -313,7 +261,7 @@ namespace Channel {
           for (auto bg : rank->m_child_nodes) {
             for (auto bank : bg->m_child_nodes) {
               bank->m_state = T::m_states["Closed"];
-              bank->m_row_state.clear();
+              bank->close_rows();
             }
           }
         }
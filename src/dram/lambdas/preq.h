@@ -12,7 +12,7 @@ int RequireRowOpen(typename T::Node* node, int cmd, int target_id, Clk_t clk) {
   switch (node->m_state) {
     case T::m_states["Closed"]: return T::m_commands["ACT"];
     case T::m_states["Opened"]: {
-      if (node->m_row_state.find(target_id) != node->m_row_state.end()) {
+      if (node->is_row_open(target_id)) {
         return cmd;
       } else {
         return T::m_commands["PRE"];
@@ -42,26 +42,28 @@ int RequireAllBanksRowOpen(typename T::Node* node, int cmd, int target_id, Clk_t
   // For HBM3
   if constexpr (T::m_levels["bank"] - T::m_levels["channel"] == 4) {
     typename T::Node* channel = node->m_parent_node->m_parent_node->m_parent_node->m_parent_node;
-    for (auto pc : channel->m_child_nodes) {
-      for (auto rank : pc->m_child_nodes) {
-        for (auto bg : rank->m_child_nodes) {
-          for (auto bank: bg->m_child_nodes) {
-            switch (bank->m_state) {
-              case T::m_states["Closed"]: return T::m_commands["ACTAB"];
-              case T::m_states["Opened"]: {
-                if (bank->m_row_state.find(target_id) != bank->m_row_state.end()) {
-                  continue;
-                } else {
-                  return T::m_commands["PREA"];
-                }
-                return cmd;
-              }
-              default: {
-                spdlog::error("[Preq::Bank] Invalid bank state for an RD/WR command!");
-                std::exit(-1);
-              }
-            }
+    // Try the incrementally maintained summary of the open rows first and only scan the banks if it is inconclusive
+    using Check = typename T::RowOpenSummary::Check;
+    switch (node->m_spec->get_all_bank_summary(channel->m_node_id).check(target_id)) {
+      case Check::AllOpen:       return cmd;
+      case Check::FirstClosed:   return T::m_commands["ACTAB"];
+      case Check::FirstConflict: return T::m_commands["PREA"];
+      case Check::Unknown:       break;
+    }
+    for (auto bank : node->m_spec->get_all_bank_targets(channel->m_node_id)) {
+      switch (bank->m_state) {
+        case T::m_states["Closed"]: return T::m_commands["ACTAB"];
+        case T::m_states["Opened"]: {
+          if (bank->is_row_open(target_id)) {
+            continue;
+          } else {
+            return T::m_commands["PREA"];
           }
+          return cmd;
+        }
+        default: {
+          spdlog::error("[Preq::Bank] Invalid bank state for an RD/WR command!");
+          std::exit(-1);
         }
       }
     }
@@ -74,28 +76,27 @@ int RequirePIMSameBanksRowOpen(typename T::Node* node, int cmd, int target_id, C
   // For HBM3
   if constexpr (T::m_levels["bank"] - T::m_levels["channel"] == 4) {
     typename T::Node* ch = node->m_parent_node->m_parent_node->m_parent_node->m_parent_node;
-    for (auto pch : ch->m_child_nodes) {
-      for (auto rank : pch->m_child_nodes) {
-        for (auto bg : rank->m_child_nodes) {
-          for (auto bank: bg->m_child_nodes) {
-            if (bank->m_node_id == node->m_node_id) {
-              switch (bank->m_state) {
-                case T::m_states["Closed"]: return T::m_commands["ACTSB"];
-                case T::m_states["Opened"]: {
-                  if (bank->m_row_state.find(target_id) != bank->m_row_state.end()) {
-                    continue;
-                  } else {
-                    return T::m_commands["PRESB"];
-                  }
-                  return cmd;
-                }
-                default: {
-                  spdlog::error("[Preq::Bank] Invalid bank state for an RD/WR command!");
-                  std::exit(-1);
-                }
-              }
-            }
+    using Check = typename T::RowOpenSummary::Check;
+    switch (node->m_spec->get_same_bank_summary(ch->m_node_id, node->m_node_id).check(target_id)) {
+      case Check::AllOpen:       return cmd;
+      case Check::FirstClosed:   return T::m_commands["ACTSB"];
+      case Check::FirstConflict: return T::m_commands["PRESB"];
+      case Check::Unknown:       break;
+    }
+    for (auto bank : node->m_spec->get_same_bank_targets(ch->m_node_id, node->m_node_id)) {
+      switch (bank->m_state) {
+        case T::m_states["Closed"]: return T::m_commands["ACTSB"];
+        case T::m_states["Opened"]: {
+          if (bank->is_row_open(target_id)) {
+            continue;
+          } else {
+            return T::m_commands["PRESB"];
           }
+          return cmd;
+        }
+        default: {
+          spdlog::error("[Preq::Bank] Invalid bank state for an RD/WR command!");
+          std::exit(-1);
         }
       }
     }
@@ -108,32 +109,22 @@ int RequirePIMPerBanksRowOpen(typename T::Node* node, int cmd, int target_id, Cl
   // For HBM3
   if constexpr (T::m_levels["bank"] - T::m_levels["channel"] == 4) {
     typename T::Node* ch = node->m_parent_node->m_parent_node->m_parent_node->m_parent_node;
-    for (auto pch : ch->m_child_nodes) {
-      for (auto rank : pch->m_child_nodes) {
-        if (rank->m_node_id == node->m_parent_node->m_parent_node->m_node_id) {
-          for (auto bg : rank->m_child_nodes) {
-            if (bg->m_node_id == node->m_parent_node->m_node_id) {
-              for (auto bank : bg->m_child_nodes) {
-                if (bank->m_node_id == node->m_node_id) {
-                  switch (bank->m_state) {
-                    case T::m_states["Closed"]: return T::m_commands["ACTPB"];
-                    case T::m_states["Opened"]: {
-                      if (bank->m_row_state.find(target_id) != bank->m_row_state.end()) {
-                        continue;
-                      } else {
-                        return T::m_commands["PREPB"];
-                      }
-                      return cmd;
-                    }
-                    default: {
-                      spdlog::error("[Preq::Bank] Invalid bank state for an RD/WR command!");
-                      std::exit(-1);
-                    }
-                  }
-                }
-              }
-            }
+    typename T::Node* bg = node->m_parent_node;
+    typename T::Node* rank = bg->m_parent_node;
+    for (auto bank : node->m_spec->get_per_bank_targets(ch->m_node_id, rank->m_node_id, bg->m_node_id, node->m_node_id)) {
+      switch (bank->m_state) {
+        case T::m_states["Closed"]: return T::m_commands["ACTPB"];
+        case T::m_states["Opened"]: {
+          if (bank->is_row_open(target_id)) {
+            continue;
+          } else {
+            return T::m_commands["PREPB"];
           }
+          return cmd;
+        }
+        default: {
+          spdlog::error("[Preq::Bank] Invalid bank state for an RD/WR command!");
+          std::exit(-1);
         }
       }
     }
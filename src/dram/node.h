@@ -3,8 +3,7 @@
 
 #include <vector>
 #include <map>
-#include <deque>
-#include <functional>
+#include <cstdint>
 #include <concepts>
 
 #include "base/type.h"
@@ -26,6 +25,206 @@ concept IsDRAMSpec = requires(T t) {
 // };
 
 
+/**
+ * @brief     Escape hatch for specs whose banks can have more than one open row (e.g., multiple row buffers).
+ * @details
+ * Such a spec declares "static constexpr bool m_multiple_row_buffers = true;" and its bank nodes then keep
+ * the state of every open row in a map instead of in a single open-row field.
+ * 
+ */
+template<typename T>
+concept HasMultipleRowBuffers = requires { requires T::m_multiple_row_buffers; };
+
+/**
+ * @brief     Specs that keep their own summary of the open rows (e.g., for broadcast commands) are notified of row changes.
+ * @details
+ * Such a spec defines "void on_open_row_change(Node* bank, int old_row, int new_row)", which is called whenever the
+ * open row of a bank changes. A closed bank has NO_OPEN_ROW. Not supported together with HasMultipleRowBuffers.
+ * 
+ */
+template<typename T>
+concept ObservesOpenRows = requires(T spec, typename T::Node* node) { spec.on_open_row_change(node, 0, 0); };
+
+template<IsDRAMSpec T>
+struct DRAMNodeBase;
+
+/**
+ * @brief     Flat storage of the nodes and their timing information in one channel
+ * @details
+ * The nodes at each level are allocated contiguously in the order of their flat id, i.e., the index of the node
+ * among all nodes at the same level of the channel (flat_id = parent_flat_id * level_size + node_id). The ready
+ * clock cycles and the issue-history of the commands of all nodes are packed into [level][node][command] tables,
+ * so that the timing information along the path of a command can be indexed directly from its address vector.
+ * 
+ */
+template<IsDRAMSpec T>
+struct DRAMChannelStorage {
+    using NodeType = typename T::Node;
+
+    int m_num_cmds = -1;
+    int m_last_level = -1;                      // The lowest level that has nodes (e.g., bank)
+    std::vector<int> m_level_sizes;             // The number of children of every node at the previous level
+    std::vector<size_t> m_level_offsets;        // The number of nodes at all levels above this level
+
+    std::vector<std::vector<NodeType>> m_nodes; // The nodes below the channel node, per level
+
+    /**
+     * @brief    Fixed-capacity circular issue-history of one command at one node.
+     * @details
+     * The entries live in m_history_clks[offset, offset + window), with the most recent entry at head.
+     * The window is the longest window of the timing constraints of the command at the level of the node.
+     * 
+     */
+    struct CommandHistory {
+      uint32_t offset = 0;
+      uint16_t window = 0;
+      uint16_t head = 0;
+    };
+
+    /**
+     * @brief    Lazily applied sibling timing of the children of one node for one command.
+     * @details
+     * A sibling constraint applies to every child except the one on the path of the issued command. Instead of
+     * updating all those siblings, their parent keeps the latest ready clock over all such updates (first), the child
+     * that the latest update excluded, and the latest ready clock over the updates that did not exclude that child
+     * (second). A child sees "first", unless it is the excluded child, which sees "second". An excluded child of -1
+     * means that the update applied to all children.
+     * 
+     */
+    struct SiblingReadyClk {
+      Clk_t first = -1;
+      Clk_t second = -1;
+      int first_excluded_child = -1;
+
+      void update(int excluded_child, Clk_t ready_clk) {
+        if (excluded_child == first_excluded_child) {
+          first = std::max(first, ready_clk);
+        } else if (ready_clk > first) {
+          second = first;
+          first = ready_clk;
+          first_excluded_child = excluded_child;
+        } else {
+          second = std::max(second, ready_clk);
+        }
+      };
+
+      Clk_t get(int child) const {
+        return child == first_excluded_child ? second : first;
+      };
+    };
+
+    std::vector<Clk_t> m_cmd_ready_clks;              // The next cycle that each command can be issued again at each node
+    std::vector<SiblingReadyClk> m_sibling_ready_clks;// The sibling timing of the children of each node for each command
+    std::vector<CommandHistory> m_cmd_histories;      // Issue-history of each command at each node
+    std::vector<Clk_t> m_history_clks;                // The entries of all issue-histories
+
+    std::vector<int> m_cmd_state_domains;             // The level of the node whose subtree holds all state a command reads or changes
+    std::vector<uint64_t> m_subtree_state_versions;   // Number of issued commands whose state domain is each node or below it
+    std::vector<uint64_t> m_scope_state_versions;     // Number of issued commands whose state domain is each node itself
+
+    DRAMChannelStorage(T* spec) {
+      m_num_cmds = T::m_commands.size();
+
+      // The node hierarchy ends above the row level, or at the first level without nodes
+      int row_level = T::m_levels["row"];
+      int num_nodes = 1;
+      m_level_sizes.push_back(1);
+      m_level_offsets.push_back(0);
+      m_last_level = 0;
+      for (int level = 1; level < row_level; level++) {
+        int level_size = spec->m_organization.count[level];
+        if (level_size <= 0) {
+          break;
+        }
+        m_level_offsets.push_back(m_level_offsets.back() + num_nodes);
+        m_level_sizes.push_back(level_size);
+        num_nodes *= level_size;
+        m_last_level = level;
+      }
+      size_t total_num_nodes = m_level_offsets.back() + num_nodes;
+
+      // Reserve the node arrays upfront so that the nodes never move
+      m_nodes.resize(m_last_level + 1);
+      for (int level = 1, n = 1; level <= m_last_level; level++) {
+        n *= m_level_sizes[level];
+        m_nodes[level].reserve(n);
+      }
+
+      m_cmd_ready_clks.resize(total_num_nodes * m_num_cmds, -1);
+      m_sibling_ready_clks.resize(total_num_nodes * m_num_cmds);
+      m_cmd_histories.resize(total_num_nodes * m_num_cmds);
+
+      // A command reads and changes the state at (or below) its scope, unless it is a broadcast
+      m_cmd_state_domains.resize(m_num_cmds);
+      for (int cmd = 0; cmd < m_num_cmds; cmd++) {
+        m_cmd_state_domains[cmd] = T::m_command_meta[cmd].is_broadcast ? 0 : std::min(T::m_command_scopes[cmd], m_last_level);
+      }
+      m_subtree_state_versions.resize(total_num_nodes, 0);
+      m_scope_state_versions.resize(total_num_nodes, 0);
+      for (int level = 0; level <= m_last_level; level++) {
+        size_t level_num_nodes = (level == m_last_level ? total_num_nodes : m_level_offsets[level + 1]) - m_level_offsets[level];
+        for (int cmd = 0; cmd < m_num_cmds; cmd++) {
+          int window = 0;
+          for (const auto& t : spec->m_timing_cons[level][cmd]) {
+            window = std::max(window, t.window);
+          }
+          if (window == 0) {
+            continue;
+          }
+          for (size_t node = 0; node < level_num_nodes; node++) {
+            CommandHistory& history = m_cmd_histories[get_slot(level, node) + cmd];
+            history.offset = m_history_clks.size();
+            history.window = window;
+            m_history_clks.resize(m_history_clks.size() + window, -1);
+          }
+        }
+      }
+    };
+
+    /**
+     * @brief    Records the issue of a command, replacing the oldest entry of its history.
+     * 
+     */
+    void push_history(size_t cmd_slot, Clk_t clk) {
+      CommandHistory& history = m_cmd_histories[cmd_slot];
+      if (history.window == 0) {
+        return;
+      }
+      history.head = (history.head == 0 ? history.window : history.head) - 1;
+      m_history_clks[history.offset + history.head] = clk;
+    };
+
+    /**
+     * @brief    Returns the n-th most recent issue of a command (0 is the most recent).
+     * 
+     */
+    Clk_t get_history(size_t cmd_slot, int n) const {
+      const CommandHistory& history = m_cmd_histories[cmd_slot];
+      int pos = history.head + n;
+      if (pos >= history.window) {
+        pos -= history.window;
+      }
+      return m_history_clks[history.offset + pos];
+    };
+
+    /**
+     * @brief    Returns the index of the first command of a node in the timing tables.
+     * 
+     */
+    size_t get_slot(int level, size_t flat_id) const {
+      return get_node_index(level, flat_id) * m_num_cmds;
+    };
+
+    /**
+     * @brief    Returns the index of a node among all nodes of the channel.
+     * 
+     */
+    size_t get_node_index(int level, size_t flat_id) const {
+      return m_level_offsets[level] + flat_id;
+    };
+};
+
+
 /**
  * @brief     CRTP-ish (?) base class of a DRAM Device Node
  * 
@@ -37,58 +236,55 @@ struct DRAMNodeBase {
     std::vector<NodeType*> m_child_nodes;
 
     T* m_spec = nullptr;
+    DRAMChannelStorage<T>* m_storage = nullptr;   // The storage of the channel, owned by the channel node
 
     int m_level = -1;      // The level of this node in the organization hierarchy
     int m_node_id = -1;    // The id of this node at this level
+    int m_flat_id = -1;    // The id of this node among all nodes at this level in the channel
     int m_size = -1;       // The size of the node (e.g., how many rows in a bank)
 
     int m_state = -1;      // The state of the node
 
-    std::vector<Clk_t> m_cmd_ready_clk;             // The next cycle that each command can be issued again at this level
-    std::vector<std::deque<Clk_t>> m_cmd_history;   // Issue-history of each command at this level
-
     using RowId_t = int;
     using RowState_t = int;
-    std::map<RowId_t, RowState_t> m_row_state;  // The state of the rows, if I am a bank-ish node
+    static constexpr RowId_t NO_OPEN_ROW = -1;
+
+    RowId_t m_open_row = NO_OPEN_ROW;           // The open row, if I am a bank-ish node
+    RowState_t m_open_row_state = -1;           // The state of the open row
+    std::map<RowId_t, RowState_t> m_row_state;  // The state of all open rows (only used with HasMultipleRowBuffers)
 
     DRAMNodeBase(T* spec, NodeType* parent, int level, int id):
     m_spec(spec), m_parent_node(parent), m_level(level), m_node_id(id) {
-      int num_cmds = T::m_commands.size();
-      m_cmd_ready_clk.resize(num_cmds, -1);
-      m_cmd_history.resize(num_cmds);
-      for (int cmd = 0; cmd < num_cmds; cmd++) {
-        int window = 0;
-        for (const auto& t : spec->m_timing_cons[level][cmd]) {
-          window = std::max(window, t.window);
-        }
-        if (window != 0) {
-          m_cmd_history[cmd].resize(window, -1);
-        } else {
-          m_cmd_history[cmd].clear();
-        }
+      static_assert(T::m_levels.size() <= AddrVec_t::capacity(), "The address vector cannot hold all levels of the spec!");
+      if (parent) {
+        m_storage = parent->m_storage;
+        m_flat_id = parent->m_flat_id * m_storage->m_level_sizes[level] + id;
+      } else {
+        // I am the channel node
+        m_storage = new DRAMChannelStorage<T>(spec);
+        m_flat_id = 0;
       }
 
       m_state = spec->m_init_states[m_level];
 
       // Recursively construct next levels
-      int next_level = level + 1;
-      int last_level = T::m_levels["row"];
-      if (next_level == last_level) {
+      if (m_level == m_storage->m_last_level) {
         return;
-      } else {
-        int next_level_size = m_spec->m_organization.count[next_level];
-        if (next_level_size == 0) {
-          return;
-        } else {
-          for (int i = 0; i < next_level_size; i++) {
-            NodeType* child = new NodeType(spec, static_cast<NodeType*>(this), next_level, i);
-            static_cast<NodeType*>(this)->m_child_nodes.push_back(child);
-          }
-        }
+      }
+      int next_level = level + 1;
+      int next_level_size = m_storage->m_level_sizes[next_level];
+      for (int i = 0; i < next_level_size; i++) {
+        NodeType* child = &m_storage->m_nodes[next_level].emplace_back(spec, static_cast<NodeType*>(this), next_level, i);
+        static_cast<NodeType*>(this)->m_child_nodes.push_back(child);
       }
     };
 
     void update_states(int command, const AddrVec_t& addr_vec, Clk_t clk) {
+      if (!m_parent_node) {
+        // I am the channel node
+        update_state_versions(command, addr_vec);
+      }
+
       int child_id = addr_vec[m_level+1];
       if (m_spec->m_actions[m_level][command]) {
         // update the state machine at this level
@@ -103,58 +299,31 @@ struct DRAMNodeBase {
     };
 
     void update_timing(int command, const AddrVec_t& addr_vec, Clk_t clk) {
-      /************************************************
-       *         Update Sibling Node Timing
-       ***********************************************/
       if (m_node_id != addr_vec[m_level]) {
-        for (const auto& t : m_spec->m_timing_cons[m_level][command]) {
-          if (!t.sibling) {
-            // not sibling timing parameter
-            continue; 
-          }
-
-          // update earliest schedulable time of every command
-          Clk_t future = clk + t.val;
-          m_cmd_ready_clk[t.cmd] = std::max(m_cmd_ready_clk[t.cmd], future); 
-        }
-        // stop recursion: only target nodes should be recursed
-        return; 
-      }
-
-      /************************************************
-       *          Update Target Node Timing
-       ***********************************************/
-      // Update history
-      if (m_cmd_history[command].size()) {
-        m_cmd_history[command].pop_back();
-        m_cmd_history[command].push_front(clk); 
+        update_sibling_timing(m_level, m_flat_id, command, clk);
+        return;
       }
 
-      for (const auto& t : m_spec->m_timing_cons[m_level][command]) {
-        if (t.sibling) {
-          continue; 
-        }
-
-        // Get the oldest history
-        Clk_t past = m_cmd_history[command][t.window-1];
-        if (past < 0) {
-          // not enough history
-          continue; 
+      // Walk down the target path. At every level below me, the target child gets the target node timing
+      // and its siblings get the sibling timing (lazily, through the sibling table of their parent).
+      int level = m_level;
+      int flat_id = m_flat_id;
+      while (true) {
+        update_target_timing(level, flat_id, command, clk);
+        if (level == m_storage->m_last_level) {
+          // stop: updated all levels
+          return;
         }
 
-        // update earliest schedulable time of every command
-        Clk_t future = past + t.val;
-        m_cmd_ready_clk[t.cmd] = std::max(m_cmd_ready_clk[t.cmd], future);
-      }
-
-      if (!m_child_nodes.size()) {
-        // stop recursion: updated all levels
-        return; 
-      }
+        int target_id = addr_vec[level + 1];
+        update_children_sibling_timing(level, flat_id, target_id, command, clk);
 
-      // recursively update all of my children
-      for (auto child : m_child_nodes) {
-        child->update_timing(command, addr_vec, clk);
+        if (target_id < 0) {
+          // stop: all children are siblings
+          return;
+        }
+        level++;
+        flat_id = flat_id * m_storage->m_level_sizes[level] + target_id;
       }
     };
 
@@ -177,20 +346,127 @@ struct DRAMNodeBase {
       return m_child_nodes[child_id]->get_preq_command(command, addr_vec, m_clk);
     };
 
+    /**
+     * @brief    Returns a version number of all state that get_preq_command() and check_rowbuffer_hit() may read for the
+     *           command, which changes whenever a command that may change this state is issued. Call it at the channel.
+     * @details
+     * The state of a command lives in the subtree of its state domain node, i.e., its scope (at most the bank), or the
+     * whole channel if it is a broadcast. Two commands can only interfere if one state domain node is an ancestor of (or
+     * the same as) the other. Hence, the version is the number of issued commands at or below the domain node, plus the
+     * number of issued commands whose domain node is an ancestor of it.
+     * 
+     */
+    uint64_t get_state_version(int command, const AddrVec_t& addr_vec) const {
+      int domain = m_storage->m_cmd_state_domains[command];
+      uint64_t version = 0;
+      int level = m_level;
+      int flat_id = m_flat_id;
+      while (true) {
+        size_t node = m_storage->get_node_index(level, flat_id);
+        int child_id = addr_vec[level + 1];
+        if (level == domain || child_id < 0) {
+          return version + m_storage->m_subtree_state_versions[node];
+        }
+        version += m_storage->m_scope_state_versions[node];
+        level++;
+        flat_id = flat_id * m_storage->m_level_sizes[level] + child_id;
+      }
+    };
+
     bool check_ready(int command, const AddrVec_t& addr_vec, Clk_t clk) {
-      if (m_cmd_ready_clk[command] != -1 && clk < m_cmd_ready_clk[command]) {
-        // stop recursion: the check failed at this level
-        return false; 
+      int scope = m_spec->m_command_scopes[command];
+      int level = m_level;
+      int flat_id = m_flat_id;
+      Clk_t sibling_ready_clk = get_sibling_ready_clk(command);
+      while (true) {
+        size_t cmd_slot = m_storage->get_slot(level, flat_id) + command;
+        Clk_t ready_clk = std::max(m_storage->m_cmd_ready_clks[cmd_slot], sibling_ready_clk);
+        if (ready_clk != -1 && clk < ready_clk) {
+          // stop: the check failed at this level
+          return false; 
+        }
+
+        int child_id = addr_vec[level + 1];
+        if (child_id < 0 || level == scope || level == m_storage->m_last_level) {
+          // stop: the check passed at all levels
+          return true; 
+        }
+
+        // check my child
+        sibling_ready_clk = m_storage->m_sibling_ready_clks[cmd_slot].get(child_id);
+        flat_id = flat_id * m_storage->m_level_sizes[level + 1] + child_id;
+        level++;
       }
+    };
 
-      int child_id = addr_vec[m_level+1];
-      if (child_id < 0 || m_level == m_spec->m_command_scopes[command] || !m_child_nodes.size()) {
-        // stop recursion: the check passed at all levels
-        return true; 
+    Clk_t get_ready_clk(int command, const AddrVec_t& addr_vec) {
+      int scope = m_spec->m_command_scopes[command];
+      int level = m_level;
+      int flat_id = m_flat_id;
+      Clk_t ready_clk = get_sibling_ready_clk(command);
+      while (true) {
+        // the command is ready only when it is ready at all levels
+        size_t cmd_slot = m_storage->get_slot(level, flat_id) + command;
+        ready_clk = std::max(ready_clk, m_storage->m_cmd_ready_clks[cmd_slot]);
+
+        int child_id = addr_vec[level + 1];
+        if (child_id < 0 || level == scope || level == m_storage->m_last_level) {
+          // stop: reached the scope of the command
+          return ready_clk;
+        }
+        ready_clk = std::max(ready_clk, m_storage->m_sibling_ready_clks[cmd_slot].get(child_id));
+
+        flat_id = flat_id * m_storage->m_level_sizes[level + 1] + child_id;
+        level++;
       }
+    };
 
-      // recursively check my child
-      return m_child_nodes[child_id]->check_ready(command, addr_vec, clk);
+    bool is_row_open(RowId_t row) const {
+      if constexpr (HasMultipleRowBuffers<T>) {
+        return m_row_state.find(row) != m_row_state.end();
+      } else {
+        return row != NO_OPEN_ROW && m_open_row == row;
+      }
+    };
+
+    RowState_t get_row_state(RowId_t row) const {
+      if constexpr (HasMultipleRowBuffers<T>) {
+        auto it = m_row_state.find(row);
+        return it != m_row_state.end() ? it->second : -1;
+      } else {
+        return is_row_open(row) ? m_open_row_state : -1;
+      }
+    };
+
+    void open_row(RowId_t row, RowState_t state) {
+      if constexpr (HasMultipleRowBuffers<T>) {
+        m_row_state[row] = state;
+      } else {
+        // A bank has a single row buffer, opening a row replaces the previously open one
+        RowId_t old_row = m_open_row;
+        m_open_row = row;
+        m_open_row_state = state;
+        if constexpr (ObservesOpenRows<T>) {
+          if (old_row != row) {
+            m_spec->on_open_row_change(static_cast<NodeType*>(this), old_row, row);
+          }
+        }
+      }
+    };
+
+    void close_rows() {
+      if constexpr (HasMultipleRowBuffers<T>) {
+        m_row_state.clear();
+      } else {
+        RowId_t old_row = m_open_row;
+        m_open_row = NO_OPEN_ROW;
+        m_open_row_state = -1;
+        if constexpr (ObservesOpenRows<T>) {
+          if (old_row != NO_OPEN_ROW) {
+            m_spec->on_open_row_change(static_cast<NodeType*>(this), old_row, NO_OPEN_ROW);
+          }
+        }
+      }
     };
 
     bool check_rowbuffer_hit(int command, const AddrVec_t& addr_vec, Clk_t m_clk) {
@@ -209,25 +485,142 @@ struct DRAMNodeBase {
       // recursively check for row hits at my child
       return m_child_nodes[child_id]->check_rowbuffer_hit(command, addr_vec, m_clk);
     };    
+
+  private:
+    /**
+     * @brief    Counts the issued command at its state domain node and at all nodes above it (see get_state_version()).
+     * 
+     */
+    void update_state_versions(int command, const AddrVec_t& addr_vec) {
+      int domain = m_storage->m_cmd_state_domains[command];
+      int level = m_level;
+      int flat_id = m_flat_id;
+      while (true) {
+        size_t node = m_storage->get_node_index(level, flat_id);
+        m_storage->m_subtree_state_versions[node]++;
+        int child_id = addr_vec[level + 1];
+        if (level == domain || child_id < 0) {
+          m_storage->m_scope_state_versions[node]++;
+          return;
+        }
+        level++;
+        flat_id = flat_id * m_storage->m_level_sizes[level] + child_id;
+      }
+    };
+
+    /**
+     * @brief    Updates the timing of a node that is on the path of the issued command.
+     * 
+     */
+    void update_target_timing(int level, int flat_id, int command, Clk_t clk) {
+      size_t slot = m_storage->get_slot(level, flat_id);
+      Clk_t* cmd_ready_clk = &m_storage->m_cmd_ready_clks[slot];
+
+      // Update history
+      m_storage->push_history(slot + command, clk);
+
+      for (const auto& t : m_spec->m_timing_cons[level][command]) {
+        if (t.sibling) {
+          continue; 
+        }
+
+        // Get the oldest history
+        Clk_t past = m_storage->get_history(slot + command, t.window-1);
+        if (past < 0) {
+          // not enough history
+          continue; 
+        }
+
+        // update earliest schedulable time of every command
+        Clk_t future = past + t.val;
+        cmd_ready_clk[t.cmd] = std::max(cmd_ready_clk[t.cmd], future);
+      }
+    };
+
+    /**
+     * @brief    Applies the sibling timing of the issued command to all children of a node except the target child.
+     * @details
+     * The children are not touched. Instead, the sibling table of the node records the update, which check_ready()
+     * and get_ready_clk() fold in when they walk down to a child.
+     * 
+     */
+    void update_children_sibling_timing(int level, int flat_id, int target_child, int command, Clk_t clk) {
+      typename DRAMChannelStorage<T>::SiblingReadyClk* sibling_ready_clk = &m_storage->m_sibling_ready_clks[m_storage->get_slot(level, flat_id)];
+      for (const auto& t : m_spec->m_timing_cons[level + 1][command]) {
+        if (!t.sibling) {
+          // not sibling timing parameter
+          continue; 
+        }
+
+        // update earliest schedulable time of every command at every sibling of the target child
+        sibling_ready_clk[t.cmd].update(target_child, clk + t.val);
+      }
+    };
+
+    /**
+     * @brief    Returns the sibling timing of a command that my parent recorded for me.
+     * 
+     */
+    Clk_t get_sibling_ready_clk(int command) const {
+      if (!m_parent_node) {
+        return -1;
+      }
+      size_t parent_slot = m_storage->get_slot(m_level - 1, m_parent_node->m_flat_id);
+      return m_storage->m_sibling_ready_clks[parent_slot + command].get(m_node_id);
+    };
+
+    /**
+     * @brief    Updates the timing of a sibling of a node that is on the path of the issued command.
+     * 
+     */
+    void update_sibling_timing(int level, int flat_id, int command, Clk_t clk) {
+      Clk_t* cmd_ready_clk = &m_storage->m_cmd_ready_clks[m_storage->get_slot(level, flat_id)];
+      for (const auto& t : m_spec->m_timing_cons[level][command]) {
+        if (!t.sibling) {
+          // not sibling timing parameter
+          continue; 
+        }
+
+        // update earliest schedulable time of every command
+        Clk_t future = clk + t.val;
+        cmd_ready_clk[t.cmd] = std::max(cmd_ready_clk[t.cmd], future); 
+      }
+    };
 };
 
+// The actions, prerequisites, and row hit/open checks are plain function pointers (i.e., the lambdas must not capture),
+// so that calling them on the hot path does not go through std::function
 template<class T>
-using ActionFunc_t = std::function<void(typename T::Node* node, int cmd, int target_id, Clk_t clk)>;
+using ActionFunc_t = void(*)(typename T::Node* node, int cmd, int target_id, Clk_t clk);
 template<class T>
-using PreqFunc_t   = std::function<int (typename T::Node* node, int cmd, int target_id, Clk_t clk)>;
+using PreqFunc_t   = int (*)(typename T::Node* node, int cmd, int target_id, Clk_t clk);
 template<class T>
-using RowhitFunc_t = std::function<bool(typename T::Node* node, int cmd, int target_id, Clk_t clk)>;
+using RowhitFunc_t = bool(*)(typename T::Node* node, int cmd, int target_id, Clk_t clk);
 template<class T>
 using RowopenFunc_t = RowhitFunc_t<T>;
 
+/**
+ * @brief     A [level][command] matrix of functions stored in one flat array.
+ * 
+ */
 template<typename T>
-using FuncMatrix = std::vector<std::vector<T>>;
-
-// TODO: Enable easy syntax for FuncMatrix lookup
-// template<typename T, int N, int M>
-// class FuncMatrix : public std::array<std::array<T, M>, N> {
+class FuncMatrix {
+  private:
+    std::vector<T> m_funcs;
+    size_t m_num_cols = 0;
+
+  public:
+    void resize(size_t num_rows, const std::vector<T>& row) {
+      m_num_cols = row.size();
+      m_funcs.clear();
+      for (size_t i = 0; i < num_rows; i++) {
+        m_funcs.insert(m_funcs.end(), row.begin(), row.end());
+      }
+    };
 
-// };
+    T* operator[](size_t row) { return &m_funcs[row * m_num_cols]; };
+    const T* operator[](size_t row) const { return &m_funcs[row * m_num_cols]; };
+};
 
 }        // namespace Ramulator
 
@@ -27,12 +27,22 @@ struct Organization {
   std::vector<int> count;
 }; 
 
+// The command bus(es) that a command is sent over
+enum class CommandBus {
+  Row,      // Row command bus (e.g., ACT, PRE, REF on HBM)
+  Column,   // Column command bus (e.g., RD, WR on HBM)
+  Both,     // A shared command bus, or the command occupies both buses
+};
+
 // Meta information about a command
 struct DRAMCommandMeta {
   bool is_opening = false;
   bool is_closing = false;
   bool is_accessing = false;
   bool is_refreshing = false;  
+  CommandBus bus = CommandBus::Both;
+  // Whether the command reads or changes the state of nodes outside the subtree of its scope (e.g., PIM broadcasts)
+  bool is_broadcast = false;
 };
 
 // Timing Constraint
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <deque>
+#include <initializer_list>
 
 #include <spdlog/spdlog.h>
 #include <yaml-cpp/yaml.h>
@@ -25,9 +26,14 @@ class IDRAMController : public Clocked<IDRAMController> {
     IRefreshManager*   m_refresh = nullptr;
 
     int m_channel_id = -1;
+
+    bool m_defer_callbacks = false;           // Whether completed reads are kept for deliver_deferred_reads() instead of calling their callbacks
+    std::vector<Request> m_deferred_reads;    // The completed reads whose callbacks were deferred, in completion order
   public:
     /**
      * @brief       Send a request to the memory controller.
+     * @details
+     * On success, the controller moves the request into its buffers, leaving req in a moved-from state.
      * 
      * @param    req        The request to be enqueued.
      * @return   true       Successful.
@@ -36,7 +42,7 @@ class IDRAMController : public Clocked<IDRAMController> {
     virtual bool send(Request& req) = 0;
 
     /**
-     * @brief       Send a high-priority request to the memory controller.
+     * @brief       Send a high-priority request to the memory controller (moved from on success).
      * 
      */
     virtual bool priority_send(Request& req) = 0;
@@ -47,11 +53,136 @@ class IDRAMController : public Clocked<IDRAMController> {
      */
     virtual void tick() = 0;
    
-    virtual bool is_pending() = 0;
-
-    // For debugging
-    Clk_t get_clk() {return m_clk;}
-
+    virtual bool is_pending() = 0;
+
+    /**
+     * @brief       Returns the number of read requests that were served by forwarding from the write buffer.
+     *
+     */
+    virtual size_t get_num_forwarded_reads() { return 0; };
+
+    /**
+     * @brief       Returns the earliest future clock cycle at which ticking the controller may change its state.
+     * @details
+     * Between now and the returned clock cycle, ticking the controller must do nothing but advance its clock
+     * (no command becomes issuable, no read request completes, no refresh is due). The default implementation
+     * returns the next cycle and therefore never allows the controller to be fast-forwarded.
+     *
+     */
+    virtual Clk_t get_next_event_clk() { return m_clk + 1; };
+
+    /**
+     * @brief       Advances the clocks of the controller and its refresh manager over idle cycles.
+     *
+     */
+    void fast_forward(Clk_t num_cycles) override {
+      m_clk += num_cycles;
+      if (m_refresh) {
+        m_refresh->fast_forward(num_cycles);
+      }
+    };
+
+    /**
+     * @brief       Calls the callbacks of the completed reads that were deferred.
+     * @details
+     * Lets the owner of a controller that is ticked on a worker thread run the callbacks, which may touch state
+     * shared with other channels (e.g., the frontend), on its own thread.
+     *
+     */
+    void deliver_deferred_reads() {
+      for (auto& req : m_deferred_reads) {
+        req.callback(req);
+      }
+      m_deferred_reads.clear();
+    };
+
+    // For debugging
+    Clk_t get_clk() {return m_clk;}
+
+  protected:
+    /**
+     * @brief       Reads the depth of a request buffer from the config of the controller implementation.
+     *
+     */
+    int get_buffer_size_param(const char* name, const char* desc, int default_val) {
+      int size = m_impl->param<int>(name).desc(desc).default_val(default_val);
+      if (size < 1) {
+        throw ConfigurationError("Invalid {} ({}) in {}!", name, size, m_impl->get_name());
+      }
+      return size;
+    };
+
+    /**
+     * @brief       Indexes the row groups (i.e., banks, etc.) of the active requests, which closing commands must not
+     *              interrupt, and of the other buffers the scheduler picks from.
+     *
+     */
+    void index_row_groups(std::initializer_list<ReqBuffer*> buffers) {
+      int row_addr_idx = m_dram->m_levels("row");
+      for (ReqBuffer* buffer : buffers) {
+        buffer->index_row_groups(row_addr_idx);
+      }
+    };
+
+    /**
+     * @brief       Whether the active buffer holds back the next command of a scheduled request.
+     * @details
+     * A closing command must not interrupt an active request to the same row group. An opening command moves the
+     * request to the active buffer (unless moves_to_active_buffer is false), so it has to wait while that is full.
+     *
+     */
+    bool is_blocked_by_active_buffer(const ReqBuffer& active_buffer, ReqBuffer::iterator req_it, bool moves_to_active_buffer) {
+      const auto& command_meta = m_dram->m_command_meta(req_it->command);
+      if (command_meta.is_closing && active_buffer.contains_row_group(req_it->addr_vec)) {
+        return true;
+      }
+      return moves_to_active_buffer && command_meta.is_opening && active_buffer.is_full();
+    };
+
+    /**
+     * @brief       Moves a request that just issued its opening command from its buffer to the active buffer. The
+     *              request stays where it is if the active buffer is full.
+     *
+     */
+    void move_to_active_buffer(ReqBuffer& active_buffer, ReqBuffer* buffer, ReqBuffer::iterator& req_it) {
+      if (m_dram->m_command_meta(req_it->command).is_opening && active_buffer.enqueue(std::move(*req_it))) {
+        buffer->remove(req_it);
+      }
+    };
+
+    /**
+     * @brief       Serves the completed read requests.
+     * @details
+     * Called at the beginning of tick(). Retires all requests in the pending queue that have received data from DRAM
+     * by this cycle as one batch, and then finishes them in depart order by calling (or deferring) their callbacks.
+     *
+     */
+    void serve_completed_reads(ReqCompletionQueue& pending, std::vector<Request>& completed_reads) {
+      if (pending.size() == 0 || pending.next_depart() > m_clk) {
+        return;
+      }
+
+      // Retire the whole batch first, so callbacks that send new requests do not interfere with the pending queue
+      pending.drain(m_clk, completed_reads);
+      for (auto& req : completed_reads) {
+        // Request received data from dram
+        if (req.depart - req.arrive > 1) {
+          // Check if this requests accesses the DRAM or is being forwarded.
+          // TODO add the stats back
+        }
+
+        if (req.callback) {
+          // If the request comes from outside (e.g., processor), call its callback
+          if (m_defer_callbacks) {
+            m_deferred_reads.push_back(std::move(req));
+          } else {
+            req.callback(req);
+          }
+        }
+      }
+      completed_reads.clear();
+    };
+
 };
 
 }       // namespace Ramulator
@@ -6,14 +6,14 @@ namespace Ramulator {
 class HBM3Controller final : public IDRAMController, public Implementation {
   RAMULATOR_REGISTER_IMPLEMENTATION(IDRAMController, HBM3Controller, "HBM3", "A HBM3 controller.");
   private:
-    std::deque<Request> pending;          // A queue for read requests that are about to finish (callback after RL)
+    ReqCompletionQueue pending;           // A depart-ordered queue for read requests that are about to finish (callback after RL)
+    std::vector<Request> m_completed_reads;   // The batch of read requests retired in the current cycle
 
     ReqBuffer m_active_buffer;            // Buffer for requests being served. This has the highest priority 
     ReqBuffer m_priority_buffer;          // Buffer for high-priority requests (e.g., maintenance like refresh).
     ReqBuffer m_read_buffer;              // Read request buffer
     ReqBuffer m_write_buffer;             // Write request buffer
 
-    int m_row_addr_idx = -1;
 
     float m_wr_low_watermark;
     float m_wr_high_watermark;
@@ -24,6 +24,7 @@ class HBM3Controller final : public IDRAMController, public Implementation {
     size_t s_num_row_hits = 0;
     size_t s_num_row_misses = 0;
     size_t s_num_row_conflicts = 0;
+    size_t s_num_forwarded_reads = 0;
 
 
   public:
@@ -31,6 +32,14 @@ class HBM3Controller final : public IDRAMController, public Implementation {
       m_wr_low_watermark =  param<float>("wr_low_watermark").desc("Threshold for switching back to read mode.").default_val(0.2f);
       m_wr_high_watermark = param<float>("wr_high_watermark").desc("Threshold for switching to write mode.").default_val(0.8f);
 
+      // A buffer accepts new requests as long as it holds at most max_size requests
+      m_active_buffer.set_max_size(get_buffer_size_param("active_buffer_size", "Maximum size of the active buffer.", 32));
+      m_priority_buffer.set_max_size(get_buffer_size_param("priority_buffer_size", "Maximum size of the priority buffer.", 512*3 + 32));
+      m_read_buffer.set_max_size(get_buffer_size_param("read_buffer_size", "Maximum size of the read request buffer.", 32));
+      m_write_buffer.set_max_size(get_buffer_size_param("write_buffer_size", "Maximum size of the write request buffer.", 32));
+      // Index the buffered write addresses for read forwarding
+      m_write_buffer.index_addresses();
+
       m_scheduler = create_child_ifce<IScheduler>();
       m_refresh = create_child_ifce<IRefreshManager>();    
 
@@ -44,8 +53,7 @@ class HBM3Controller final : public IDRAMController, public Implementation {
 
     void setup(IFrontEnd* frontend, IMemorySystem* memory_system) override {
       m_dram = memory_system->get_ifce<IDRAM>();
-      m_row_addr_idx = m_dram->m_levels("row");
-      m_priority_buffer.max_size = 512*3 + 32;
+      index_row_groups({&m_active_buffer, &m_read_buffer, &m_write_buffer});
     };
 
     bool send(Request& req) override {
@@ -53,13 +61,11 @@ class HBM3Controller final : public IDRAMController, public Implementation {
 
       // Forward existing write requests to incoming read requests
       if (req.type_id == Request::Type::Read) {
-        auto compare_addr = [req](const Request& wreq) {
-          return wreq.addr == req.addr;
-        };
-        if (std::find_if(m_write_buffer.begin(), m_write_buffer.end(), compare_addr) != m_write_buffer.end()) {
+        if (m_write_buffer.contains_addr(req.addr)) {
           // The request will depart at the next cycle
+          s_num_forwarded_reads++;
           req.depart = m_clk + 1;
-          pending.push_back(req);
+          pending.push(std::move(req));
           return true;
         }
       }
@@ -68,9 +74,9 @@ class HBM3Controller final : public IDRAMController, public Implementation {
       bool is_success = false;
       req.arrive = m_clk;
       if        (req.type_id == Request::Type::Read) {
-        is_success = m_read_buffer.enqueue(req);
+        is_success = m_read_buffer.enqueue(std::move(req));
       } else if (req.type_id == Request::Type::Write) {
-        is_success = m_write_buffer.enqueue(req);
+        is_success = m_write_buffer.enqueue(std::move(req));
       } else {
         throw std::runtime_error("Invalid request type!");
       }
@@ -87,7 +93,7 @@ class HBM3Controller final : public IDRAMController, public Implementation {
       req.final_command = m_dram->m_request_translations(req.type_id);
 
       bool is_success = false;
-      is_success = m_priority_buffer.enqueue(req);
+      is_success = m_priority_buffer.enqueue(std::move(req));
       return is_success;
     }
 
@@ -95,7 +101,7 @@ class HBM3Controller final : public IDRAMController, public Implementation {
       m_clk++;
 
       // 1. Serve completed reads
-      serve_completed_reads();
+      serve_completed_reads(pending, m_completed_reads);
 
       m_refresh->tick();
 
@@ -103,6 +109,8 @@ class HBM3Controller final : public IDRAMController, public Implementation {
       ReqBuffer::iterator req_it;
       ReqBuffer* buffer = nullptr;
       bool request_found = schedule_request(req_it, buffer);
+      // The command of the request picked by the scheduler (if any), which a second request can be paired with in 5.
+      int first_command = req_it.is_valid() ? req_it->command : -1;
 
       // 3. Update all plugins
       for (auto plugin : m_plugins) {
@@ -113,46 +121,46 @@ class HBM3Controller final : public IDRAMController, public Implementation {
       if (request_found) {
         // If we find a real request to serve
         m_dram->issue_command(req_it->command, req_it->addr_vec);
+        if (req_it->issue < 0) {
+          req_it->issue = m_clk;
+        }
 
         // If we are issuing the last command, set depart clock cycle and move the request to the pending queue
         if (req_it->command == req_it->final_command) {
           if (req_it->type_id == Request::Type::Read) {
             req_it->depart = m_clk + m_dram->m_read_latency;
-            pending.push_back(*req_it);
+            pending.push(std::move(*req_it));
           } else if (req_it->type_id == Request::Type::Write) {
             // TODO: Add code to update statistics
           }
           buffer->remove(req_it);
         } else {
-          if (m_dram->m_command_meta(req_it->command).is_opening) {
-            m_active_buffer.enqueue(*req_it);
-            buffer->remove(req_it);
-          }
+          move_to_active_buffer(m_active_buffer, buffer, req_it);
         }
       }
 
       // 5. If next command is ROW/COL command while issued command is COL/ROW command, issue next command concurrently
       ReqBuffer::iterator sec_req_it;
       ReqBuffer* sec_buffer = nullptr;
-      bool sec_request_found = schedule_sec_request(sec_req_it, buffer, req_it->command);
+      bool sec_request_found = schedule_sec_request(sec_req_it, buffer, first_command);
       for (auto plugin : m_plugins) {
         plugin->update(sec_request_found, sec_req_it);
       }
       if (sec_request_found) {
         m_dram->issue_command(sec_req_it->command, sec_req_it->addr_vec);
+        if (sec_req_it->issue < 0) {
+          sec_req_it->issue = m_clk;
+        }
 
         if (sec_req_it->command == sec_req_it->final_command) {
           if (sec_req_it->type_id == Request::Type::Read) {
             sec_req_it->depart = m_clk + m_dram->m_read_latency;
-            pending.push_back(*sec_req_it);
+            pending.push(std::move(*sec_req_it));
           } else if (sec_req_it->type_id == Request::Type::Write) {
           }
           buffer->remove(sec_req_it);
         } else {
-          if (m_dram->m_command_meta(sec_req_it->command).is_opening) {
-            m_active_buffer.enqueue(*sec_req_it);
-            buffer->remove(sec_req_it);
-          }
+          move_to_active_buffer(m_active_buffer, buffer, sec_req_it);
         }
       }
     };
@@ -163,50 +171,66 @@ class HBM3Controller final : public IDRAMController, public Implementation {
       return is_pending;
     };
 
-  private:
-    /**
-     * @brief    Helper function to serve the completed read requests
-     * @details
-     * This function is called at the beginning of the tick() function.
-     * It checks the pending queue to see if the top request has received data from DRAM.
-     * If so, it finishes this request by calling its callback and poping it from the pending queue.
-     */
-    void serve_completed_reads() {
+    size_t get_num_forwarded_reads() override {
+      return s_num_forwarded_reads;
+    };
+
+    Clk_t get_next_event_clk() override {
+      // Plugins that keep their own notion of time need to be updated every cycle
+      for (auto plugin : m_plugins) {
+        if (!plugin->supports_fast_forward()) {
+          return m_clk + 1;
+        }
+      }
+
+      // The read/write mode switch happens in the next tick
+      if (get_next_write_mode() != m_is_write_mode) {
+        return m_clk + 1;
+      }
+
+      Clk_t next_clk = m_refresh->get_next_refresh_clk();
+
+      // The next pending read request to complete
       if (pending.size()) {
-        // Check the first pending request
-        auto& req = pending[0];
-        if (req.depart <= m_clk) {
-          // Request received data from dram
-          if (req.depart - req.arrive > 1) {
-            // Check if this requests accesses the DRAM or is being forwarded.
-            // TODO add the stats back
-          }
+        next_clk = std::min(next_clk, pending.next_depart());
+      }
 
-          if (req.callback) {
-            // If the request comes from outside (e.g., processor), call its callback
-            req.callback(req);
-          }
-          // Finally, remove this request from the pending queue
-          pending.pop_front();
+      // A buffered request cannot be scheduled before the next command it needs becomes ready
+      for (auto buffer : {&m_active_buffer, &m_priority_buffer, &m_read_buffer, &m_write_buffer}) {
+        for (auto& req : *buffer) {
+          int command = m_dram->get_preq_command(req.final_command, req.addr_vec);
+          next_clk = std::min(next_clk, m_dram->get_ready_clk(command, req.addr_vec));
         }
-      };
-    };
+      }
 
+      return std::max(next_clk, m_clk + 1);
+    };
 
+  private:
     /**
      * @brief    Checks if we need to switch to write mode
      * 
      */
     void set_write_mode() {
+      m_is_write_mode = get_next_write_mode();
+    };
+
+
+    /**
+     * @brief    Returns whether set_write_mode() would put the controller in write mode
+     * 
+     */
+    bool get_next_write_mode() {
       if (!m_is_write_mode) {
         if ((m_write_buffer.size() > m_wr_high_watermark * m_write_buffer.max_size) || m_read_buffer.size() == 0) {
-          m_is_write_mode = true;
+          return true;
         }
       } else {
         if ((m_write_buffer.size() < m_wr_low_watermark * m_write_buffer.max_size) && m_read_buffer.size() != 0) {
-          m_is_write_mode = false;
+          return false;
         }
       }
+      return m_is_write_mode;
     };
 
 
@@ -250,20 +274,10 @@ class HBM3Controller final : public IDRAMController, public Implementation {
         }
       }
 
-      // 2.3 If we find a request to schedule, we need to check if it will close an opened row in the active buffer.
-      if (request_found) {
-        if (m_dram->m_command_meta(req_it->command).is_closing) {
-          std::vector<Addr_t> rowgroup((req_it->addr_vec).begin(), (req_it->addr_vec).begin() + m_row_addr_idx);
-
-          // Search the active buffer with the row address (inkl. banks, etc.)
-          for (auto _it = m_active_buffer.begin(); _it != m_active_buffer.end(); _it++) {
-            std::vector<Addr_t> _it_rowgroup(_it->addr_vec.begin(), _it->addr_vec.begin() + m_row_addr_idx);
-            if (rowgroup == _it_rowgroup) {
-              // Invalidate this scheduling outcome if we are to interrupt a request in the active buffer
-              request_found = false;
-            }
-          }
-        }
+      // 2.3 If we find a request to schedule, we need to check if it will close an opened row in the active buffer,
+      //     or if it cannot move to the active buffer because that is full.
+      if (request_found && is_blocked_by_active_buffer(m_active_buffer, req_it, req_buffer != &m_active_buffer)) {
+        request_found = false;
       }
 
       return request_found;
@@ -279,7 +293,7 @@ class HBM3Controller final : public IDRAMController, public Implementation {
       // 5.1    First, check the act buffer to serve requests that are already activating (avoid useless ACTs)
       if (req_it= m_scheduler->get_best_request(m_active_buffer); req_it != m_active_buffer.end()) {
         if (m_dram->check_ready(req_it->command, req_it->addr_vec)) {
-          if (compare_command_type(first_command, req_it->command)) {
+          if (m_dram->can_issue_concurrently(first_command, req_it->command)) {
             request_found = true;
             req_buffer = &m_active_buffer;
           }
@@ -294,7 +308,7 @@ class HBM3Controller final : public IDRAMController, public Implementation {
           req_it = m_priority_buffer.begin();
           req_it->command = m_dram->get_preq_command(req_it->final_command, req_it->addr_vec);
           
-          if (compare_command_type(first_command, req_it->command)) {
+          if (m_dram->can_issue_concurrently(first_command, req_it->command)) {
             request_found = m_dram->check_ready(req_it->command, req_it->addr_vec);
             if (!request_found & m_priority_buffer.size() != 0) {
               return false;
@@ -308,7 +322,7 @@ class HBM3Controller final : public IDRAMController, public Implementation {
           set_write_mode();
           auto& buffer = m_is_write_mode ? m_write_buffer : m_read_buffer;
           if (req_it = m_scheduler->get_best_request(buffer); req_it != buffer.end()) {
-            if (compare_command_type(first_command, req_it->command)) {
+            if (m_dram->can_issue_concurrently(first_command, req_it->command)) {
               request_found = m_dram->check_ready(req_it->command, req_it->addr_vec);
               req_buffer = &buffer;
             }
@@ -316,59 +330,15 @@ class HBM3Controller final : public IDRAMController, public Implementation {
         }
       }
 
-      // 5.3 If we find a request to schedule, we need to check if it will close an opened row in the active buffer.
-      if (request_found) {
-        if (m_dram->m_command_meta(req_it->command).is_closing) {
-          std::vector<Addr_t> rowgroup((req_it->addr_vec).begin(), (req_it->addr_vec).begin() + m_row_addr_idx);
-
-          // Search the active buffer with the row address (inkl. banks, etc.)
-          for (auto _it = m_active_buffer.begin(); _it != m_active_buffer.end(); _it++) {
-            std::vector<Addr_t> _it_rowgroup(_it->addr_vec.begin(), _it->addr_vec.begin() + m_row_addr_idx);
-            if (rowgroup == _it_rowgroup) {
-              // Invalidate this scheduling outcome if we are to interrupt a request in the active buffer
-              request_found = false;
-            }
-          }
-        }
+      // 5.3 If we find a request to schedule, we need to check if it will close an opened row in the active buffer,
+      //     or if it cannot move to the active buffer because that is full.
+      if (request_found && is_blocked_by_active_buffer(m_active_buffer, req_it, req_buffer != &m_active_buffer)) {
+        request_found = false;
       }
 
       return request_found;
     }
 
-    // Row command: 0,  Col command: 1
-    int get_command_type(int command) {
-      switch (command)  {
-          case 0:  return 0; // ACT,   Row command
-          case 1:  return 0; // PRE,   Row command
-          case 2:  return 0; // PREA,  Row command
-          case 3:  return 1; // RD,    Col command
-          case 4:  return 1; // WR,    Col command
-          case 5:  return 1; // RDA,   Col command
-          case 6:  return 1; // WRA,   Col command
-          case 7:  return 0; // REFab, Row command
-          case 8:  return 0; // REBsb, Row command
-          case 9:  return 0; // RFMab, Row command
-          case 10: return 0; // RFMsb, Row command
-          default: return -1;
-      }
-    }
-
-    bool compare_command_type(int first_command, int second_command) {
-      int first_command_type = get_command_type(first_command);
-      int second_command_type = get_command_type(second_command);
- 
-      if (first_command_type == -1 || second_command_type == -1) {
-        return false;
-      }
-
-      if (first_command_type == second_command_type) {
-        return false;
-      }
-      else {
-        return true;
-      }
-    }
-
 
 };
   
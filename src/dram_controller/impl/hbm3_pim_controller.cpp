@@ -6,7 +6,8 @@ namespace Ramulator {
 class HBM3PIMController final : public IDRAMController, public Implementation {
   RAMULATOR_REGISTER_IMPLEMENTATION(IDRAMController, HBM3PIMController, "HBM3-PIM", "A HBM3-PIM controller.");
   private:
-    std::deque<Request> pending;          // A queue for read requests that are about to finish (callback after RL)
+    ReqCompletionQueue pending;           // A depart-ordered queue for read requests that are about to finish (callback after RL)
+    std::vector<Request> m_completed_reads;   // The batch of read requests retired in the current cycle
 
     ReqBuffer m_active_buffer;            // Buffer for requests being served. This has the highest priority 
     ReqBuffer m_priority_buffer;          // Buffer for high-priority requests (e.g., maintenance like refresh).
@@ -14,7 +15,6 @@ class HBM3PIMController final : public IDRAMController, public Implementation {
     ReqBuffer m_write_buffer;             // Write request buffer
     ReqBuffer m_pim_buffer;               // PIM request buffer (in-order, higher priority than read/write buffer, lower priority than priority buffer)
 
-    int m_row_addr_idx = -1;
 
     float m_wr_low_watermark;
     float m_wr_high_watermark;
@@ -25,14 +25,22 @@ class HBM3PIMController final : public IDRAMController, public Implementation {
     size_t s_num_row_hits = 0;
     size_t s_num_row_misses = 0;
     size_t s_num_row_conflicts = 0;
-
-    bool is_pim = false;
+    size_t s_num_forwarded_reads = 0;
 
   public:
     void init() override {
       m_wr_low_watermark =  param<float>("wr_low_watermark").desc("Threshold for switching back to read mode.").default_val(0.2f);
       m_wr_high_watermark = param<float>("wr_high_watermark").desc("Threshold for switching to write mode.").default_val(0.8f);
 
+      // A buffer accepts new requests as long as it holds at most max_size requests
+      m_active_buffer.set_max_size(get_buffer_size_param("active_buffer_size", "Maximum size of the active buffer.", 32));
+      m_priority_buffer.set_max_size(get_buffer_size_param("priority_buffer_size", "Maximum size of the priority buffer.", 512*3 + 32));
+      m_read_buffer.set_max_size(get_buffer_size_param("read_buffer_size", "Maximum size of the read request buffer.", 32));
+      m_write_buffer.set_max_size(get_buffer_size_param("write_buffer_size", "Maximum size of the write request buffer.", 32));
+      // Index the buffered write addresses for read forwarding
+      m_write_buffer.index_addresses();
+      m_pim_buffer.set_max_size(get_buffer_size_param("pim_buffer_size", "Maximum size of the PIM request buffer.", 32));
+
       m_scheduler = create_child_ifce<IScheduler>();
       m_refresh = create_child_ifce<IRefreshManager>();    
 
@@ -46,8 +54,7 @@ class HBM3PIMController final : public IDRAMController, public Implementation {
 
     void setup(IFrontEnd* frontend, IMemorySystem* memory_system) override {
       m_dram = memory_system->get_ifce<IDRAM>();
-      m_row_addr_idx = m_dram->m_levels("row");
-      m_priority_buffer.max_size = 512*3 + 32;
+      index_row_groups({&m_active_buffer, &m_read_buffer, &m_write_buffer, &m_pim_buffer});
     };
 
     bool send(Request& req) override {
@@ -55,13 +62,11 @@ class HBM3PIMController final : public IDRAMController, public Implementation {
 
       // Forward existing write requests to incoming read requests
       if (req.type_id == Request::Type::Read) {
-        auto compare_addr = [req](const Request& wreq) {
-          return wreq.addr == req.addr;
-        };
-        if (std::find_if(m_write_buffer.begin(), m_write_buffer.end(), compare_addr) != m_write_buffer.end()) {
+        if (m_write_buffer.contains_addr(req.addr)) {
           // The request will depart at the next cycle
+          s_num_forwarded_reads++;
           req.depart = m_clk + 1;
-          pending.push_back(req);
+          pending.push(std::move(req));
           return true;
         }
       }
@@ -70,18 +75,18 @@ class HBM3PIMController final : public IDRAMController, public Implementation {
       bool is_success = false;
       req.arrive = m_clk;
       switch (req.type_id) {
-        case Request::Type::Read:           is_success = m_read_buffer.enqueue(req);  break;
-        case Request::Type::Write:          is_success = m_write_buffer.enqueue(req); break;
-        case Request::Type::PIM_MAC_AB:     is_success = m_pim_buffer.enqueue(req);   break;
-        case Request::Type::PIM_MAC_SB:     is_success = m_pim_buffer.enqueue(req);   break;
-        case Request::Type::PIM_MAC_PB:     is_success = m_pim_buffer.enqueue(req);   break;
-        case Request::Type::PIM_WR_GB:      is_success = m_pim_buffer.enqueue(req);   break;
-        case Request::Type::PIM_MV_SB:      is_success = m_pim_buffer.enqueue(req);   break;
-        case Request::Type::PIM_MV_GB:      is_success = m_pim_buffer.enqueue(req);   break;
-        case Request::Type::PIM_SFM:        is_success = m_pim_buffer.enqueue(req);   break;
-        case Request::Type::PIM_SET_MODEL:  is_success = m_pim_buffer.enqueue(req);   break;
-        case Request::Type::PIM_SET_HEAD:   is_success = m_pim_buffer.enqueue(req);   break;
-        case Request::Type::PIM_BARRIER:    is_success = m_pim_buffer.enqueue(req);   break;
+        case Request::Type::Read:           is_success = m_read_buffer.enqueue(std::move(req));  break;
+        case Request::Type::Write:          is_success = m_write_buffer.enqueue(std::move(req)); break;
+        case Request::Type::PIM_MAC_AB:     is_success = m_pim_buffer.enqueue(std::move(req));   break;
+        case Request::Type::PIM_MAC_SB:     is_success = m_pim_buffer.enqueue(std::move(req));   break;
+        case Request::Type::PIM_MAC_PB:     is_success = m_pim_buffer.enqueue(std::move(req));   break;
+        case Request::Type::PIM_WR_GB:      is_success = m_pim_buffer.enqueue(std::move(req));   break;
+        case Request::Type::PIM_MV_SB:      is_success = m_pim_buffer.enqueue(std::move(req));   break;
+        case Request::Type::PIM_MV_GB:      is_success = m_pim_buffer.enqueue(std::move(req));   break;
+        case Request::Type::PIM_SFM:        is_success = m_pim_buffer.enqueue(std::move(req));   break;
+        case Request::Type::PIM_SET_MODEL:  is_success = m_pim_buffer.enqueue(std::move(req));   break;
+        case Request::Type::PIM_SET_HEAD:   is_success = m_pim_buffer.enqueue(std::move(req));   break;
+        case Request::Type::PIM_BARRIER:    is_success = m_pim_buffer.enqueue(std::move(req));   break;
         default: throw std::runtime_error("Invalid request type!");
       }
 
@@ -98,7 +103,7 @@ class HBM3PIMController final : public IDRAMController, public Implementation {
       req.final_command = m_dram->m_request_translations(req.type_id);
 
       bool is_success = false;
-      is_success = m_priority_buffer.enqueue(req);
+      is_success = m_priority_buffer.enqueue(std::move(req));
       return is_success;
     }
 
@@ -106,7 +111,7 @@ class HBM3PIMController final : public IDRAMController, public Implementation {
       m_clk++;
 
       // 1. Serve completed reads
-      serve_completed_reads();
+      serve_completed_reads(pending, m_completed_reads);
 
       m_refresh->tick();
 
@@ -114,6 +119,8 @@ class HBM3PIMController final : public IDRAMController, public Implementation {
       ReqBuffer::iterator req_it;
       ReqBuffer* buffer = nullptr;
       bool request_found = schedule_request(req_it, buffer);
+      // The command of the request picked by the scheduler (if any), which a second request can be paired with in 5.
+      int first_command = req_it.is_valid() ? req_it->command : -1;
 
       // 3. Update all plugins
       for (auto plugin : m_plugins) {
@@ -124,22 +131,23 @@ class HBM3PIMController final : public IDRAMController, public Implementation {
       if (request_found) {
         // If we find a real request to serve
         m_dram->issue_command(req_it->command, req_it->addr_vec);
+        if (req_it->issue < 0) {
+          req_it->issue = m_clk;
+        }
 
         // If we are issuing the last command, set depart clock cycle and move the request to the pending queue
         if (req_it->command == req_it->final_command) {
           if (req_it->type_id == Request::Type::Read) {
             req_it->depart = m_clk + m_dram->m_read_latency;
-            pending.push_back(*req_it);
+            pending.push(std::move(*req_it));
           } else if (req_it->type_id == Request::Type::Write) {
             // TODO: Add code to update statistics
           }
           buffer->remove(req_it);
         } else {
-          if (!is_pim) {
-            if (m_dram->m_command_meta(req_it->command).is_opening) {
-              m_active_buffer.enqueue(*req_it);
-              buffer->remove(req_it);
-            }
+          // PIM requests are served in-order from the PIM buffer and never move to the active buffer
+          if (buffer != &m_pim_buffer) {
+            move_to_active_buffer(m_active_buffer, buffer, req_it);
           }
         }
       }
@@ -148,26 +156,26 @@ class HBM3PIMController final : public IDRAMController, public Implementation {
       ReqBuffer::iterator sec_req_it;
       ReqBuffer* sec_buffer = nullptr;
       bool sec_request_found = false;
-      sec_request_found = schedule_sec_request(sec_req_it, buffer, req_it->command);
+      sec_request_found = schedule_sec_request(sec_req_it, buffer, first_command);
       for (auto plugin : m_plugins) {
         plugin->update(sec_request_found, sec_req_it);
       }
       if (sec_request_found) {
         m_dram->issue_command(sec_req_it->command, sec_req_it->addr_vec);
+        if (sec_req_it->issue < 0) {
+          sec_req_it->issue = m_clk;
+        }
 
         if (sec_req_it->command == sec_req_it->final_command) {
           if (sec_req_it->type_id == Request::Type::Read) {
             sec_req_it->depart = m_clk + m_dram->m_read_latency;
-            pending.push_back(*sec_req_it);
+            pending.push(std::move(*sec_req_it));
           } else if (sec_req_it->type_id == Request::Type::Write) {
           }
           buffer->remove(sec_req_it);
         } else {
-          if (!is_pim) {
-            if (m_dram->m_command_meta(sec_req_it->command).is_opening) {
-              m_active_buffer.enqueue(*sec_req_it);
-              buffer->remove(sec_req_it);
-            }
+          if (buffer != &m_pim_buffer) {
+            move_to_active_buffer(m_active_buffer, buffer, sec_req_it);
           }
         }
       }
@@ -179,50 +187,77 @@ class HBM3PIMController final : public IDRAMController, public Implementation {
       return is_pending;
     };
 
-  private:
-    /**
-     * @brief    Helper function to serve the completed read requests
-     * @details
-     * This function is called at the beginning of the tick() function.
-     * It checks the pending queue to see if the top request has received data from DRAM.
-     * If so, it finishes this request by calling its callback and poping it from the pending queue.
-     */
-    void serve_completed_reads() {
+    size_t get_num_forwarded_reads() override {
+      return s_num_forwarded_reads;
+    };
+
+    Clk_t get_next_event_clk() override {
+      // Plugins that keep their own notion of time need to be updated every cycle
+      for (auto plugin : m_plugins) {
+        if (!plugin->supports_fast_forward()) {
+          return m_clk + 1;
+        }
+      }
+
+      // The read/write mode switch happens in the next tick
+      if (get_next_write_mode() != m_is_write_mode) {
+        return m_clk + 1;
+      }
+
+      // The scheduler drops the barrier at the head of the PIM buffer in the next tick
+      if (m_pim_buffer.size() && m_pim_buffer.begin()->type_id == Request::Type::PIM_BARRIER) {
+        return m_clk + 1;
+      }
+
+      Clk_t next_clk = m_refresh->get_next_refresh_clk();
+
+      // The next pending read request to complete
       if (pending.size()) {
-        // Check the first pending request
-        auto& req = pending[0];
-        if (req.depart <= m_clk) {
-          // Request received data from dram
-          if (req.depart - req.arrive > 1) {
-            // Check if this requests accesses the DRAM or is being forwarded.
-            // TODO add the stats back
-          }
+        next_clk = std::min(next_clk, pending.next_depart());
+      }
 
-          if (req.callback) {
-            // If the request comes from outside (e.g., processor), call its callback
-            req.callback(req);
+      // A buffered request cannot be scheduled before the next command it needs becomes ready. Only the requests in
+      // the scheduling window (e.g., the next epochs of the PIM buffer) can be scheduled before a request leaves.
+      for (auto buffer : {&m_active_buffer, &m_priority_buffer, &m_read_buffer, &m_write_buffer, &m_pim_buffer}) {
+        auto window_end = (buffer == &m_priority_buffer) ? buffer->end() : m_scheduler->get_window_end(*buffer);
+        for (auto it = buffer->begin(); it != window_end; it++) {
+          if (it->type_id == Request::Type::PIM_BARRIER) {
+            // Barriers are never issued to the device
+            continue;
           }
-          // Finally, remove this request from the pending queue
-          pending.pop_front();
+          int command = m_dram->get_preq_command(it->final_command, it->addr_vec);
+          next_clk = std::min(next_clk, m_dram->get_ready_clk(command, it->addr_vec));
         }
-      };
-    };
+      }
 
+      return std::max(next_clk, m_clk + 1);
+    };
 
+  private:
     /**
      * @brief    Checks if we need to switch to write mode
      * 
      */
     void set_write_mode() {
+      m_is_write_mode = get_next_write_mode();
+    };
+
+
+    /**
+     * @brief    Returns whether set_write_mode() would put the controller in write mode
+     * 
+     */
+    bool get_next_write_mode() {
       if (!m_is_write_mode) {
         if ((m_write_buffer.size() > m_wr_high_watermark * m_write_buffer.max_size) || m_read_buffer.size() == 0) {
-          m_is_write_mode = true;
+          return true;
         }
       } else {
         if ((m_write_buffer.size() < m_wr_low_watermark * m_write_buffer.max_size) && m_read_buffer.size() != 0) {
-          m_is_write_mode = false;
+          return false;
         }
       }
+      return m_is_write_mode;
     };
 
 
@@ -254,7 +289,6 @@ class HBM3PIMController final : public IDRAMController, public Implementation {
           }
         }
 
-        is_pim = false;
         // 2.2.2    If no request to be scheduled in the priority buffer, check the pim buffer for PIM operations.
         if (!request_found) {
           auto& buffer = m_pim_buffer;
@@ -262,9 +296,6 @@ class HBM3PIMController final : public IDRAMController, public Implementation {
             request_found = m_dram->check_ready(req_it->command, req_it->addr_vec);
             req_buffer = &buffer;
           }
-          if (request_found) {
-            is_pim = true;
-          }
         }
 
 
@@ -280,20 +311,10 @@ class HBM3PIMController final : public IDRAMController, public Implementation {
         }
       }
 
-      // 2.3 If we find a request to schedule, we need to check if it will close an opened row in the active buffer.
-      if (request_found) {
-        if (m_dram->m_command_meta(req_it->command).is_closing) {
-          std::vector<Addr_t> rowgroup((req_it->addr_vec).begin(), (req_it->addr_vec).begin() + m_row_addr_idx);
-
-          // Search the active buffer with the row address (inkl. banks, etc.)
-          for (auto _it = m_active_buffer.begin(); _it != m_active_buffer.end(); _it++) {
-            std::vector<Addr_t> _it_rowgroup(_it->addr_vec.begin(), _it->addr_vec.begin() + m_row_addr_idx);
-            if (rowgroup == _it_rowgroup) {
-              // Invalidate this scheduling outcome if we are to interrupt a request in the active buffer
-              request_found = false;
-            }
-          }
-        }
+      // 2.3 If we find a request to schedule, we need to check if it will close an opened row in the active buffer,
+      //     or if it cannot move to the active buffer because that is full.
+      if (request_found && is_blocked_by_active_buffer(m_active_buffer, req_it, req_buffer != &m_active_buffer && req_buffer != &m_pim_buffer)) {
+        request_found = false;
       }
 
       return request_found;
@@ -309,7 +330,7 @@ class HBM3PIMController final : public IDRAMController, public Implementation {
       // 5.1    First, check the act buffer to serve requests that are already activating (avoid useless ACTs)
       if (req_it= m_scheduler->get_best_request(m_active_buffer); req_it != m_active_buffer.end()) {
         if (m_dram->check_ready(req_it->command, req_it->addr_vec)) {
-          if (compare_command_type(first_command, req_it->command)) {
+          if (m_dram->can_issue_concurrently(first_command, req_it->command)) {
             request_found = true;
             req_buffer = &m_active_buffer;
           }
@@ -324,7 +345,7 @@ class HBM3PIMController final : public IDRAMController, public Implementation {
           req_it = m_priority_buffer.begin();
           req_it->command = m_dram->get_preq_command(req_it->final_command, req_it->addr_vec);
           
-          if (compare_command_type(first_command, req_it->command)) {
+          if (m_dram->can_issue_concurrently(first_command, req_it->command)) {
             request_found = m_dram->check_ready(req_it->command, req_it->addr_vec);
             if (!request_found & m_priority_buffer.size() != 0) {
               return false;
@@ -332,19 +353,15 @@ class HBM3PIMController final : public IDRAMController, public Implementation {
           }
         }
 
-        is_pim = false;
         // 2.2.2    If no request to be scheduled in the priority buffer, check the pim buffer for PIM operations.
         if (!request_found) {
           auto& buffer = m_pim_buffer;
           if (req_it = m_scheduler->get_best_request(buffer); req_it != buffer.end()) {
-            if (compare_command_type(first_command, req_it->command)) {
+            if (m_dram->can_issue_concurrently(first_command, req_it->command)) {
               request_found = m_dram->check_ready(req_it->command, req_it->addr_vec);
               req_buffer = &buffer;
             }
           }
-          if (request_found) {
-            is_pim = true;
-          }
         }
 
 
@@ -354,7 +371,7 @@ class HBM3PIMController final : public IDRAMController, public Implementation {
           set_write_mode();
           auto& buffer = m_is_write_mode ? m_write_buffer : m_read_buffer;
           if (req_it = m_scheduler->get_best_request(buffer); req_it != buffer.end()) {
-            if (compare_command_type(first_command, req_it->command)) {
+            if (m_dram->can_issue_concurrently(first_command, req_it->command)) {
               request_found = m_dram->check_ready(req_it->command, req_it->addr_vec);
               req_buffer = &buffer;
             }
@@ -362,64 +379,14 @@ class HBM3PIMController final : public IDRAMController, public Implementation {
         }
       }
 
-      // 5.3 If we find a request to schedule, we need to check if it will close an opened row in the active buffer.
-      if (request_found) {
-        if (m_dram->m_command_meta(req_it->command).is_closing) {
-          std::vector<Addr_t> rowgroup((req_it->addr_vec).begin(), (req_it->addr_vec).begin() + m_row_addr_idx);
-
-          // Search the active buffer with the row address (inkl. banks, etc.)
-          for (auto _it = m_active_buffer.begin(); _it != m_active_buffer.end(); _it++) {
-            std::vector<Addr_t> _it_rowgroup(_it->addr_vec.begin(), _it->addr_vec.begin() + m_row_addr_idx);
-            if (rowgroup == _it_rowgroup) {
-              // Invalidate this scheduling outcome if we are to interrupt a request in the active buffer
-              request_found = false;
-            }
-          }
-        }
+      // 5.3 If we find a request to schedule, we need to check if it will close an opened row in the active buffer,
+      //     or if it cannot move to the active buffer because that is full.
+      if (request_found && is_blocked_by_active_buffer(m_active_buffer, req_it, req_buffer != &m_active_buffer && req_buffer != &m_pim_buffer)) {
+        request_found = false;
       }
 
       return request_found;
     }
-
-    // Row command: 0,  Col command: 1
-    int get_command_type(int command) {
-      if      (command == m_dram->m_commands("ACT"))   return 0; // Row command
-      else if (command == m_dram->m_commands("PRE"))   return 0; // Row command
-      else if (command == m_dram->m_commands("PREA"))  return 0; // Row command
-      else if (command == m_dram->m_commands("RD"))    return 1; // Col command
-      else if (command == m_dram->m_commands("WR"))    return 1; // Col command
-      else if (command == m_dram->m_commands("REFab")) return 0; // Row command
-      else if (command == m_dram->m_commands("REFsb")) return 0; // Row command
-      else if (command == m_dram->m_commands("ACTAB")) return 0; // Row command
-      else if (command == m_dram->m_commands("ACTSB")) return 0; // Row command
-      else if (command == m_dram->m_commands("ACTPB")) return 0; // Row command
-      else if (command == m_dram->m_commands("MACAB")) return 1; // Col command
-      else if (command == m_dram->m_commands("MACSB")) return 1; // Col command
-      else if (command == m_dram->m_commands("MACPB")) return 1; // Col command
-      else if (command == m_dram->m_commands("WRGB"))  return 1; // Col command
-      else if (command == m_dram->m_commands("MVSB"))  return 1; // Col command
-      else if (command == m_dram->m_commands("MVGB"))  return 1; // Col command
-      else if (command == m_dram->m_commands("SFM"))   return 1; // Col command
-      else if (command == m_dram->m_commands("SETM"))  return 1; // Col command
-      else if (command == m_dram->m_commands("SETH"))  return 1; // Col command
-      else return -1;
-    }
-
-    bool compare_command_type(int first_command, int second_command) {
-      int first_command_type = get_command_type(first_command);
-      int second_command_type = get_command_type(second_command);
- 
-      if (first_command_type == -1 || second_command_type == -1) {
-        return false;
-      }
-
-      if (first_command_type == second_command_type) {
-        return false;
-      }
-      else {
-        return true;
-      }
-    }
 };
   
 }   // namespace Ramulator
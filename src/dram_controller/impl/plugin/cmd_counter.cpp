@@ -53,6 +53,8 @@ class CommandCounter : public IControllerPlugin, public Implementation {
       }
     };
 
+    bool supports_fast_forward() override { return true; };
+
     void finalize() override {
       std::ofstream output(m_save_path);
       for (const auto& [cmd_id, count] : m_command_counters) {
@@ -21,8 +21,6 @@ class TraceRecorder : public IControllerPlugin, public Implementation {
     std::filesystem::path m_trace_path; 
     Logger_t m_tracer;
 
-    Clk_t m_clk = 0;
-
   public:
     void init() override { 
       m_trace_path = param<std::string>("path").desc("Path to the trace file").required();
@@ -44,12 +42,10 @@ class TraceRecorder : public IControllerPlugin, public Implementation {
     };
 
     void update(bool request_found, ReqBuffer::iterator& req_it) override {
-      m_clk++;
-
       if (request_found) {
         m_tracer->trace(
           "{}, {}, {}", 
-          m_clk,
+          m_ctrl->get_clk(),
           m_dram->m_commands(req_it->command),
           fmt::join(req_it->addr_vec, ", ")
         );
@@ -57,6 +53,8 @@ class TraceRecorder : public IControllerPlugin, public Implementation {
 
     };
 
+    bool supports_fast_forward() override { return true; };
+
 };
 
 }       // namespace Ramulator
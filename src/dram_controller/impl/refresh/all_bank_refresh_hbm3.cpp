@@ -43,7 +43,7 @@ class AllBankRefreshHBM3 : public IRefreshManager, public Implementation {
       if (m_clk == m_next_refresh_cycle) {
         m_next_refresh_cycle += m_nrefi;
         for (int r = 0; r < m_num_ranks; r++) {
-          std::vector<int> addr_vec(m_dram_org_levels, -1);
+          AddrVec_t addr_vec(m_dram_org_levels, -1);
           addr_vec[0] = m_ctrl->m_channel_id;
           addr_vec[1] = r;
           Request req(addr_vec, m_ref_req_id);
@@ -56,6 +56,14 @@ class AllBankRefreshHBM3 : public IRefreshManager, public Implementation {
       }
     };
 
+    Clk_t get_next_refresh_clk() override {
+      return m_next_refresh_cycle;
+    };
+
+    void fast_forward(Clk_t num_cycles) override {
+      m_clk += num_cycles;
+    };
+
 };
 
 }       // namespace Ramulator
@@ -1,4 +1,5 @@
 #include <vector>
+#include <limits>
 
 #include "base/base.h"
 #include "dram_controller/controller.h"
@@ -41,6 +42,15 @@ class NoRefresh : public IRefreshManager, public Implementation {
       m_clk++;
     };
 
+    Clk_t get_next_refresh_clk() override {
+      // Never refreshes
+      return std::numeric_limits<Clk_t>::max();
+    };
+
+    void fast_forward(Clk_t num_cycles) override {
+      m_clk += num_cycles;
+    };
+
 };
 
 }       // namespace Ramulator
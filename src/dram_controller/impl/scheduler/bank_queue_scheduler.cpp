@@ -0,0 +1,226 @@
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
+#include "base/base.h"
+#include "dram_controller/controller.h"
+#include "dram_controller/scheduler.h"
+#include "dram_controller/impl/scheduler/bank_rowhits.h"
+
+namespace Ramulator {
+
+/**
+ * @brief    FRFCFS scheduler that keeps the buffered requests bucketed per bank.
+ * @details
+ * Makes exactly the same decisions as FRFCFS, without comparing every pair of buffered requests each cycle.
+ *
+ * The requests of a bank (i.e., of a row group of the buffer, see ReqBuffer::index_row_groups()) are split into
+ * queues of requests that share the same prerequisite command and row hit status. All requests of such a queue
+ * are ready at the same time, so readiness is checked once per queue, and each queue remembers, for every request,
+ * the oldest request (by arrival) from there on in buffer order. The queues of a bank are only rebuilt when a request
+ * joins or leaves the bank, or when the state of the bank changes. Selection then costs the number of active banks
+ * (times a binary search per queue) rather than the number of buffered requests.
+ *
+ * Requires the buffers it schedules from to index their row groups.
+ *
+ */
+class BankQueueFRFCFS : public IScheduler, public Implementation {
+  RAMULATOR_REGISTER_IMPLEMENTATION(IScheduler, BankQueueFRFCFS, "BankQueueFRFCFS", "FRFCFS DRAM Scheduler with per-bank request queues.")
+  private:
+    IDRAM* m_dram;
+
+    struct Queue {
+      int command = -1;
+      bool is_rowhit = false;
+      bool is_ready = false;
+      std::vector<ReqBuffer::iterator> requests;    // The requests of the queue in buffer order
+      std::vector<int> oldest_from;                 // Per position, the request that arrived first from there on
+    };
+
+    struct BankQueues {
+      uint64_t num_updates = -1;        // The ReqBuffer::RowGroup::num_updates the queues were built for
+      uint64_t state_version = -1;      // The device state version the queues were built for
+      bool is_volatile = false;         // Whether the requests depend on different device states
+      bool has_rowhit = false;
+      std::vector<Queue> queues;
+    };
+
+    // The queues of each bank, indexed by the row group id in the buffer
+    std::unordered_map<const ReqBuffer*, std::vector<BankQueues>> m_bank_queues;
+
+  public:
+    void init() override { };
+
+    void setup(IFrontEnd* frontend, IMemorySystem* memory_system) override {
+      m_dram = cast_parent<IDRAMController>()->m_dram;
+    };
+
+
+    /**
+     * @brief    Ready requests first, then FCFS. Unlike get_best_request(), a single comparison cannot tell whether
+     *           another request of the bank is a row hit.
+     *
+     */
+    ReqBuffer::iterator compare(ReqBuffer::iterator req1, ReqBuffer::iterator req2) override {
+      bool ready1 = m_dram->check_ready(req1->command, req1->addr_vec);
+      bool ready2 = m_dram->check_ready(req2->command, req2->addr_vec);
+
+      if (ready1 ^ ready2) {
+        return ready1 ? req1 : req2;
+      }
+
+      // Fallback to FCFS
+      if (req1->arrive <= req2->arrive) {
+        return req1;
+      } else {
+        return req2;
+      }
+    }
+
+
+    ReqBuffer::iterator get_best_request(ReqBuffer& buffer) override {
+      if (buffer.size() == 0) {
+        return buffer.end();
+      }
+      if (!buffer.is_row_group_indexed()) {
+        throw std::runtime_error("BankQueueFRFCFS requires the row groups of the request buffers to be indexed!");
+      }
+
+      std::vector<BankQueues>& banks = m_bank_queues[&buffer];
+      const std::vector<int>& active_banks = buffer.get_active_row_groups();
+
+      for (int bank_id : active_banks) {
+        if (size_t(bank_id) >= banks.size()) {
+          banks.resize(bank_id + 1);
+        }
+        BankQueues& bank = banks[bank_id];
+        update_bank_queues(buffer, bank_id, bank);
+        for (Queue& queue : bank.queues) {
+          queue.is_ready = m_dram->check_ready(queue.command, queue.requests.front()->addr_vec);
+        }
+      }
+
+      // FRFCFS walks the buffer in order and keeps the older of two requests that are both ready or both not ready.
+      // A ready request replaces a request that is not ready, unless it is not a row hit while another request to
+      // its bank is. Hence:
+      //   - If the first request is ready, the oldest ready request wins.
+      //   - Otherwise, the first ready request that is not held back by a row hit takes over, and the oldest ready
+      //     request from there on wins.
+      //   - If there is no such request, the oldest request that is not ready wins.
+      auto head = buffer.begin();
+      if (find_queue(banks[buffer.get_row_group_id(head)], *head).is_ready) {
+        return find_oldest(buffer, banks, true, 0);
+      }
+
+      uint64_t first_seq = std::numeric_limits<uint64_t>::max();
+      for (int bank_id : active_banks) {
+        const BankQueues& bank = banks[bank_id];
+        for (const Queue& queue : bank.queues) {
+          if (queue.is_ready && (queue.is_rowhit || !bank.has_rowhit)) {
+            first_seq = std::min(first_seq, buffer.get_seq(queue.requests.front()));
+          }
+        }
+      }
+
+      if (first_seq != std::numeric_limits<uint64_t>::max()) {
+        return find_oldest(buffer, banks, true, first_seq);
+      } else {
+        return find_oldest(buffer, banks, false, 0);
+      }
+    }
+
+  private:
+    /**
+     * @brief    Rebuilds the queues of a bank if a request joined or left it, or if the bank state changed.
+     *
+     */
+    void update_bank_queues(ReqBuffer& buffer, int bank_id, BankQueues& bank) {
+      auto head = buffer.row_group_begin(bank_id);
+      uint64_t state_version = m_dram->get_state_version(head->final_command, head->addr_vec);
+      if (!bank.is_volatile && bank.num_updates == buffer.get_row_group(bank_id).num_updates && bank.state_version == state_version) {
+        return;
+      }
+
+      bank.num_updates = buffer.get_row_group(bank_id).num_updates;
+      bank.state_version = state_version;
+      bank.is_volatile = false;
+      bank.has_rowhit = false;
+      bank.queues.clear();
+
+      for (auto it = head; it.is_valid(); it = buffer.row_group_next(it)) {
+        BankRowHits::update_preq_command(m_dram, *it);
+        // Requests whose final commands depend on a wider state (e.g., broadcast commands) cannot be tracked with
+        // the state version of the first request, so rebuild the queues every time
+        bank.is_volatile |= (it->state_version != state_version);
+        bank.has_rowhit |= it->is_rowhit;
+
+        Queue* queue = nullptr;
+        for (Queue& q : bank.queues) {
+          if (q.command == it->command && q.is_rowhit == it->is_rowhit) {
+            queue = &q;
+            break;
+          }
+        }
+        if (queue == nullptr) {
+          queue = &bank.queues.emplace_back();
+          queue->command = it->command;
+          queue->is_rowhit = it->is_rowhit;
+        }
+        queue->requests.push_back(it);
+      }
+
+      for (Queue& queue : bank.queues) {
+        int num_requests = queue.requests.size();
+        queue.oldest_from.resize(num_requests);
+        queue.oldest_from[num_requests - 1] = num_requests - 1;
+        for (int i = num_requests - 2; i >= 0; i--) {
+          // Keep the earlier request in buffer order on a tie
+          int oldest = queue.oldest_from[i + 1];
+          queue.oldest_from[i] = (queue.requests[i]->arrive <= queue.requests[oldest]->arrive) ? i : oldest;
+        }
+      }
+    };
+
+    Queue& find_queue(BankQueues& bank, const Request& req) {
+      for (Queue& queue : bank.queues) {
+        if (queue.command == req.command && queue.is_rowhit == req.is_rowhit) {
+          return queue;
+        }
+      }
+      throw std::runtime_error("Request not found in the queues of its bank!");
+    };
+
+    /**
+     * @brief    The request that arrived first (the first one in buffer order on a tie) among the requests that are
+     *           (not) ready and not before min_seq in buffer order.
+     *
+     */
+    ReqBuffer::iterator find_oldest(ReqBuffer& buffer, std::vector<BankQueues>& banks, bool is_ready, uint64_t min_seq) {
+      ReqBuffer::iterator best = buffer.end();
+      auto consider = [&](ReqBuffer::iterator it) {
+        if (!best.is_valid() || it->arrive < best->arrive ||
+            (it->arrive == best->arrive && buffer.get_seq(it) < buffer.get_seq(best))) {
+          best = it;
+        }
+      };
+
+      for (int bank_id : buffer.get_active_row_groups()) {
+        for (const Queue& queue : banks[bank_id].queues) {
+          if (queue.is_ready != is_ready) {
+            continue;
+          }
+          // Binary search for the first request of the queue that is not before min_seq
+          auto from = std::partition_point(queue.requests.begin(), queue.requests.end(), [&](ReqBuffer::iterator it) {
+            return buffer.get_seq(it) < min_seq;
+          });
+          if (from != queue.requests.end()) {
+            consider(queue.requests[queue.oldest_from[from - queue.requests.begin()]]);
+          }
+        }
+      }
+      return best;
+    };
+};
+
+}       // namespace Ramulator
@@ -0,0 +1,133 @@
+#ifndef     RAMULATOR_CONTROLLER_SCHEDULER_BANK_ROWHITS_H
+#define     RAMULATOR_CONTROLLER_SCHEDULER_BANK_ROWHITS_H
+
+#include <vector>
+#include <limits>
+#include <unordered_map>
+
+#include "base/base.h"
+#include "dram/dram.h"
+
+namespace Ramulator {
+
+/**
+ * @brief    Keeps the prerequisite commands and row hits of the requests of a buffer up to date, and counts the row
+ *           hits per bank (i.e., per row group of the buffer, see ReqBuffer::index_row_groups()).
+ * @details
+ * The requests of a bank are only revisited when a request joins or leaves the bank, when the device state of the
+ * bank changes (see IDRAM::get_state_version()), or when the range of requests that are considered changes. Hence,
+ * keeping the row hits up to date costs the number of active banks per cycle plus the number of requests in the banks
+ * that changed, rather than the number of buffered requests.
+ *
+ * Requires the buffers to index their row groups.
+ *
+ */
+class BankRowHits {
+  private:
+    struct Bank {
+      uint64_t num_updates = -1;        // The ReqBuffer::RowGroup::num_updates the bank was counted for
+      uint64_t state_version = -1;      // The device state version the bank was counted for
+      uint64_t end_seq = 0;             // The end of the range of requests (in buffer order) the bank was counted for
+      bool is_volatile = false;         // Whether the requests depend on different device states
+      int num_rowhits = 0;
+    };
+
+    IDRAM* m_dram = nullptr;
+    int m_row_addr_idx = -1;
+
+    // The banks of each buffer, indexed by the row group id in the buffer
+    std::unordered_map<const ReqBuffer*, std::vector<Bank>> m_banks;
+    ReqBuffer* m_buffer = nullptr;      // The buffer of the last update()
+    std::vector<Bank>* m_buffer_banks = nullptr;
+
+  public:
+    void setup(IDRAM* dram) {
+      m_dram = dram;
+      m_row_addr_idx = m_dram->m_levels("row");
+    };
+
+    /**
+     * @brief    Updates the prerequisite command and row hit of the request, unless the device state they depend on
+     *           did not change since they were last computed.
+     *
+     */
+    static void update_preq_command(IDRAM* dram, Request& req) {
+      uint64_t state_version = dram->get_state_version(req.final_command, req.addr_vec);
+      if (req.state_version == state_version) {
+        return;
+      }
+      req.command = dram->get_preq_command(req.final_command, req.addr_vec);
+      req.is_rowhit = dram->check_rowbuffer_hit(req.command, req.addr_vec);
+      req.state_version = state_version;
+    };
+
+    /**
+     * @brief    Brings the requests of the buffer that precede end_seq in buffer order (see ReqBuffer::get_seq())
+     *           and the row hit counts of their banks up to date. Later requests are neither updated nor counted.
+     *
+     */
+    void update(ReqBuffer& buffer, uint64_t end_seq = std::numeric_limits<uint64_t>::max()) {
+      if (!buffer.is_row_group_indexed()) {
+        throw std::runtime_error("The scheduler requires the row groups of the request buffers to be indexed!");
+      }
+
+      m_buffer = &buffer;
+      m_buffer_banks = &m_banks[&buffer];
+      std::vector<Bank>& banks = *m_buffer_banks;
+      for (int bank_id : buffer.get_active_row_groups()) {
+        if (size_t(bank_id) >= banks.size()) {
+          banks.resize(bank_id + 1);
+        }
+        update_bank(buffer, bank_id, banks[bank_id], end_seq);
+      }
+    };
+
+    /**
+     * @brief    Whether a counted request to the bank of the request (in the buffer of the last update()) is a row hit.
+     *
+     */
+    bool has_rowhit(ReqBuffer::iterator it) const {
+      return (*m_buffer_banks)[m_buffer->get_row_group_id(it)].num_rowhits > 0;
+    };
+
+  private:
+    /**
+     * @brief    Whether get_state_version() of the two commands changes at the same time for the same bank. Mirrors the
+     *           state domains of the channel nodes (the scope of a command capped at the bank, or the whole channel for
+     *           broadcasts), capping at the level above the row in case the device has no nodes down to the bank.
+     *
+     */
+    bool has_same_state_domain(int command1, int command2) const {
+      auto domain = [this](int command) {
+        return m_dram->m_command_meta(command).is_broadcast ? 0 : std::min<int>(m_dram->m_command_scopes(command), m_row_addr_idx - 1);
+      };
+      return command1 == command2 || domain(command1) == domain(command2);
+    };
+
+    void update_bank(ReqBuffer& buffer, int bank_id, Bank& bank, uint64_t end_seq) {
+      auto head = buffer.row_group_begin(bank_id);
+      uint64_t state_version = m_dram->get_state_version(head->final_command, head->addr_vec);
+      // A moved range end only matters if the bank has requests between the old and the new end
+      bool is_range_changed = bank.end_seq != end_seq && buffer.get_seq(buffer.row_group_last(bank_id)) >= std::min(bank.end_seq, end_seq);
+      if (!bank.is_volatile && !is_range_changed && bank.num_updates == buffer.get_row_group(bank_id).num_updates && bank.state_version == state_version) {
+        return;
+      }
+
+      bank.num_updates = buffer.get_row_group(bank_id).num_updates;
+      bank.state_version = state_version;
+      bank.end_seq = end_seq;
+      bank.is_volatile = false;
+      bank.num_rowhits = 0;
+      for (auto it = head; it.is_valid() && buffer.get_seq(it) < end_seq; it = buffer.row_group_next(it)) {
+        update_preq_command(m_dram, *it);
+        // Requests whose state version does not follow the one of the first request (e.g., broadcast commands among
+        // bank commands) cannot be tracked with it, so revisit the bank every time
+        bank.is_volatile |= !has_same_state_domain(it->final_command, head->final_command);
+        bank.num_rowhits += it->is_rowhit;
+      }
+    };
+};
+
+}       // namespace Ramulator
+
+#endif  // RAMULATOR_CONTROLLER_SCHEDULER_BANK_ROWHITS_H
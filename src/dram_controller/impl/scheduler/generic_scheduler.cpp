@@ -3,6 +3,7 @@
 #include "base/base.h"
 #include "dram_controller/controller.h"
 #include "dram_controller/scheduler.h"
+#include "dram_controller/impl/scheduler/bank_rowhits.h"
 
 namespace Ramulator {
 
@@ -11,24 +12,17 @@ class FRFCFS : public IScheduler, public Implementation {
   private:
     IDRAM* m_dram;
 
+    BankRowHits m_rowhits;    // The prerequisite commands of the requests and the row hits per bank
+
   public:
     void init() override { };
 
     void setup(IFrontEnd* frontend, IMemorySystem* memory_system) override {
       m_dram = cast_parent<IDRAMController>()->m_dram;
+      m_rowhits.setup(m_dram);
     };
 
-    std::vector<AddrVec_t> rowhit_list;
- 
-    AddrVec_t get_bank_addr_vec (Request req) {
-      AddrVec_t bank_addr_vec;
-      for (auto itr = req.addr_vec.begin(); itr != (req.addr_vec.begin() + m_dram->m_levels("row")); itr++) {
-        bank_addr_vec.push_back(*itr);
-      }
-      return bank_addr_vec;
-    };
-
-
+
     ReqBuffer::iterator compare(ReqBuffer::iterator req1, ReqBuffer::iterator req2) override {
       bool ready1 = m_dram->check_ready(req1->command, req1->addr_vec);
       bool ready2 = m_dram->check_ready(req2->command, req2->addr_vec);
@@ -38,10 +32,8 @@ class FRFCFS : public IScheduler, public Implementation {
           return req1;
         }
         else {
-          if (!m_dram->check_rowbuffer_hit(req2->command, req2->addr_vec)) {
-            if (std::find(rowhit_list.begin(), rowhit_list.end(), get_bank_addr_vec(*req2)) != rowhit_list.end()) {
-              return req1;
-            }
+          if (!req2->is_rowhit && m_rowhits.has_rowhit(req2)) {
+            return req1;
           }
           return req2;
         }
@@ -61,17 +53,8 @@ class FRFCFS : public IScheduler, public Implementation {
         return buffer.end();
       }
 
-      for (auto& req : buffer) {
-        req.command = m_dram->get_preq_command(req.final_command, req.addr_vec);
-      }
-
-      // Store row buffer hit history
-      rowhit_list.clear();
-      for (auto& req : buffer) {
-        if (m_dram->check_rowbuffer_hit(req.command, req.addr_vec)) {
-          rowhit_list.push_back(get_bank_addr_vec(req));
-        }
-      }
+      // Bring the prerequisites and the row hits of the banks whose requests or state changed up to date
+      m_rowhits.update(buffer);
 
       auto candidate = buffer.begin();
 
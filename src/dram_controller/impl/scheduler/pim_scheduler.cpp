@@ -1,8 +1,10 @@
 #include <vector>
+#include <limits>
 
 #include "base/base.h"
 #include "dram_controller/controller.h"
 #include "dram_controller/scheduler.h"
+#include "dram_controller/impl/scheduler/bank_rowhits.h"
 
 namespace Ramulator {
 
@@ -11,21 +13,18 @@ class PIM : public IScheduler, public Implementation {
   private:
     IDRAM* m_dram;
 
+    BankRowHits m_rowhits;    // The prerequisite commands of the requests and the row hits per bank
+
+    int m_lookahead_epochs = 1;
+
   public:
-    void init() override { };
+    void init() override {
+      m_lookahead_epochs = param<int>("lookahead_epochs").desc("Number of barrier-delimited epochs after the current one from which opening and closing commands may be scheduled early (-1: all).").default_val(1);
+    };
 
     void setup(IFrontEnd* frontend, IMemorySystem* memory_system) override {
       m_dram = cast_parent<IDRAMController>()->m_dram;
-    };
-
-    std::vector<AddrVec_t> rowhit_list;
- 
-    AddrVec_t get_bank_addr_vec (Request req) {
-      AddrVec_t bank_addr_vec;
-      for (auto itr = req.addr_vec.begin(); itr != (req.addr_vec.begin() + m_dram->m_levels("row")); itr++) {
-        bank_addr_vec.push_back(*itr);
-      }
-      return bank_addr_vec;
+      m_rowhits.setup(m_dram);
     };
 
 
@@ -38,10 +37,8 @@ class PIM : public IScheduler, public Implementation {
           return req1;
         }
         else {
-          if (!m_dram->check_rowbuffer_hit(req2->command, req2->addr_vec)) {
-            if (std::find(rowhit_list.begin(), rowhit_list.end(), get_bank_addr_vec(*req2)) != rowhit_list.end()) {          
-              return req1;
-            }
+          if (!req2->is_rowhit && m_rowhits.has_rowhit(req2)) {
+            return req1;
           }
           return req2;
         }
@@ -60,18 +57,6 @@ class PIM : public IScheduler, public Implementation {
         return buffer.end();
       }
 
-      for (auto& req : buffer) {
-        req.command = m_dram->get_preq_command(req.final_command, req.addr_vec);
-      }
-
-      // Store row buffer hit history
-      rowhit_list.clear();
-      for (auto& req : buffer) {
-        if (m_dram->check_rowbuffer_hit(req.command, req.addr_vec)) {
-          rowhit_list.push_back(get_bank_addr_vec(req));
-        }
-      }
-
       auto candidate = buffer.begin();
 
       if (candidate->type_id == Request::Type::PIM_BARRIER) {
@@ -82,10 +67,15 @@ class PIM : public IScheduler, public Implementation {
         candidate = buffer.begin();
       }
 
+      // Requests past the window are not inspected, so the cost per tick is bounded by the epoch size rather than the
+      // buffer size. Bring the prerequisites and the row hits of the window up to date.
+      auto window_end = get_window_end(buffer);
+      m_rowhits.update(buffer, window_end.is_valid() ? buffer.get_seq(window_end) : std::numeric_limits<uint64_t>::max());
+
       // barrier 之后的指令不会被取到，保证执行的顺序
 
       bool barrier = false;
-      for (auto next = std::next(buffer.begin(), 1); next != buffer.end(); next++) {
+      for (auto next = std::next(buffer.begin(), 1); next != window_end; next++) {
         if (next->type_id == Request::Type::PIM_BARRIER) {
           barrier = true;
         }
@@ -95,6 +85,21 @@ class PIM : public IScheduler, public Implementation {
       }
       return candidate;
     }
+
+    /**
+     * @brief    The scheduling window is the current epoch (up to the first barrier) and the next m_lookahead_epochs
+     *           epochs.
+     *
+     */
+    ReqBuffer::iterator get_window_end(ReqBuffer& buffer) override {
+      auto window_end = buffer.begin();
+      for (int num_barriers = 0; window_end != buffer.end(); window_end++) {
+        if (window_end->type_id == Request::Type::PIM_BARRIER && num_barriers++ == m_lookahead_epochs) {
+          break;
+        }
+      }
+      return window_end;
+    };
 };
 
 }       // namespace Ramulator
@@ -18,6 +18,15 @@ class IControllerPlugin {
 
   public:
     virtual void update(bool request_found, ReqBuffer::iterator& req_it) = 0;
+
+    /**
+     * @brief    Whether the plugin still behaves correctly if update() is not called in idle cycles.
+     * @details
+     * Plugins that keep their own notion of time (e.g., count update() calls) must be updated every cycle,
+     * which prevents the controller from fast-forwarding over idle cycles.
+     *
+     */
+    virtual bool supports_fast_forward() { return false; };
 };
 
 }        // namespace Ramulator
@@ -14,6 +14,18 @@ class IRefreshManager {
 
   public:
     virtual void tick() = 0;
+
+    /**
+     * @brief    Returns the next clock cycle at which the refresh manager will send refresh requests.
+     *
+     */
+    virtual Clk_t get_next_refresh_clk() = 0;
+
+    /**
+     * @brief    Advances the clock of the refresh manager over idle cycles without ticking.
+     *
+     */
+    virtual void fast_forward(Clk_t num_cycles) = 0;
 };
 
 }        // namespace Ramulator
@@ -16,6 +16,13 @@ class IScheduler {
     virtual ReqBuffer::iterator compare(ReqBuffer::iterator req1, ReqBuffer::iterator req2) = 0;
 
     virtual ReqBuffer::iterator get_best_request(ReqBuffer& buffer) = 0;
+
+    /**
+     * @brief    The end of the requests that get_best_request() considers. The requests from there on cannot be
+     *           scheduled before the requests ahead of them leave the buffer.
+     * 
+     */
+    virtual ReqBuffer::iterator get_window_end(ReqBuffer& buffer) { return buffer.end(); };
 };
 
 }       // namespace Ramulator
@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include <functional>
+#include <limits>
 
 #include "base/base.h"
 #include "memory_system/memory_system.h"
@@ -31,6 +32,24 @@ class IFrontEnd : public Clocked<IFrontEnd>, public TopLevel<IFrontEnd> {
 
     virtual bool is_finished() = 0;
 
+    /**
+     * @brief    Whether the frontend is blocked on the memory system (e.g., its last request was rejected).
+     * @details
+     * A stalled frontend cannot make progress until the memory system changes its state,
+     * so the memory system can be fast-forwarded over its idle cycles.
+     *
+     */
+    virtual bool is_stalled() { return false; };
+
+    /**
+     * @brief    The number of upcoming cycles in which the frontend will not send any request.
+     * @details
+     * A finished or stalled frontend waits on the memory system, so it leaves bounding the idle cycles to the memory
+     * system. Frontends that send their requests at known cycles (e.g., timed traces) report the cycles until the next one.
+     *
+     */
+    virtual Clk_t get_num_idle_cycles() { return (is_finished() || is_stalled()) ? std::numeric_limits<Clk_t>::max() : 0; };
+
     virtual void finalize() { 
       for (auto component : m_components) {
         component->finalize();
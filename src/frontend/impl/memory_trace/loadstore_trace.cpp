@@ -3,6 +3,7 @@
 #include <fstream>
 
 #include "frontend/frontend.h"
+#include "frontend/trace_stream.h"
 #include "base/exception.h"
 
 namespace Ramulator {
@@ -17,13 +18,12 @@ class LoadStoreTrace : public IFrontEnd, public Implementation {
       bool is_write;
       Addr_t addr;
     };
-    std::vector<Trace> m_trace;
-
-    size_t m_trace_length = 0;
-    size_t m_curr_trace_idx = 0;
+    std::unique_ptr<TraceStream<Trace>> m_trace;
 
     size_t m_trace_count = 0;
 
+    bool m_is_stalled = false;       // Whether the last request was rejected by the memory system
+
     Logger_t m_logger;
 
   public:
@@ -31,10 +31,15 @@ class LoadStoreTrace : public IFrontEnd, public Implementation {
       std::string trace_path_str = param<std::string>("path").desc("Path to the load store trace file.").required();
       m_clock_ratio = param<uint>("clock_ratio").required();
 
+      int stream_buffer_size = param<int>("stream_buffer_size").desc("Number of parsed trace lines buffered ahead of the simulation.").default_val(1 << 16);
+
       m_logger = Logging::create_logger("LoadStoreTrace");
-      m_logger->info("Loading trace file {} ...", trace_path_str);
-      init_trace(trace_path_str);
-      m_logger->info("Loaded {} lines.", m_trace.size());
+      m_logger->info("Streaming trace file {} ...", trace_path_str);
+      m_trace = std::make_unique<TraceStream<Trace>>(
+        trace_path_str,
+        [trace_path_str](const std::string& line, Trace& trace) { return parse_line(trace_path_str, line, trace); },
+        stream_buffer_size
+      );
     };
 
 
@@ -44,67 +49,60 @@ class LoadStoreTrace : public IFrontEnd, public Implementation {
       }
       bool req_full = false;
       while(!req_full && !is_finished()) {
-      const Trace& t = m_trace[m_curr_trace_idx];
+      const Trace& t = *m_trace->peek();
       bool request_sent = m_memory_system->send({t.addr, t.is_write ? Request::Type::Write : Request::Type::Read});
       if (request_sent) {
-        m_curr_trace_idx = (m_curr_trace_idx + 1) % m_trace_length;
+        m_trace->pop();
         m_trace_count++;
       }
         else {
           req_full = true;
         }
       }
+      m_is_stalled = req_full;
     };
 
 
   private:
-    void init_trace(const std::string& file_path_str) {
-      fs::path trace_path(file_path_str);
-      if (!fs::exists(trace_path)) {
-        throw ConfigurationError("Trace {} does not exist!", file_path_str);
+    /**
+     * @brief    Parses a trace line. Runs on the trace stream thread.
+     * 
+     */
+    static bool parse_line(const std::string& file_path_str, const std::string& line, Trace& trace) {
+      std::vector<std::string> tokens;
+      tokenize(tokens, line, " ");
+
+      // TODO: Add line number here for better error messages
+      if (tokens.size() != 2) {
+        throw ConfigurationError("Trace {} format invalid!", file_path_str);
       }
 
-      std::ifstream trace_file(trace_path);
-      if (!trace_file.is_open()) {
-        throw ConfigurationError("Trace {} cannot be opened!", file_path_str);
+      bool is_write = false; 
+      if (tokens[0] == "LD") {
+        is_write = false;
+      } else if (tokens[0] == "ST") {
+        is_write = true;
+      } else {
+        throw ConfigurationError("Trace {} format invalid!", file_path_str);
       }
 
-      std::string line;
-      while (std::getline(trace_file, line)) {
-        std::vector<std::string> tokens;
-        tokenize(tokens, line, " ");
-
-        // TODO: Add line number here for better error messages
-        if (tokens.size() != 2) {
-          throw ConfigurationError("Trace {} format invalid!", file_path_str);
-        }
-
-        bool is_write = false; 
-        if (tokens[0] == "LD") {
-          is_write = false;
-        } else if (tokens[0] == "ST") {
-          is_write = true;
-        } else {
-          throw ConfigurationError("Trace {} format invalid!", file_path_str);
-        }
-
-        Addr_t addr = -1;
-        if (tokens[1].compare(0, 2, "0x") == 0 | tokens[1].compare(0, 2, "0X") == 0) {
-          addr = std::stoll(tokens[1].substr(2), nullptr, 16);
-        } else {
-          addr = std::stoll(tokens[1]);
-        }
-        m_trace.push_back({is_write, addr});
+      Addr_t addr = -1;
+      if (tokens[1].compare(0, 2, "0x") == 0 || tokens[1].compare(0, 2, "0X") == 0) {
+        addr = std::stoll(tokens[1].substr(2), nullptr, 16);
+      } else {
+        addr = std::stoll(tokens[1]);
       }
+      trace = {is_write, addr};
+      return true;
+    };
 
-      trace_file.close();
-
-      m_trace_length = m_trace.size();
+    bool is_stalled() override {
+      return m_is_stalled;
     };
 
     // TODO: FIXME
     bool is_finished() override {
-      return m_trace_count >= m_trace_length; 
+      return m_trace->peek() == nullptr;
     };
 };
 
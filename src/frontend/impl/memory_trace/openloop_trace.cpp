@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <fstream>
+
+#include "frontend/frontend.h"
+#include "frontend/trace_stream.h"
+#include "frontend/trace_opcodes.h"
+#include "base/exception.h"
+
+namespace Ramulator {
+
+/**
+ * @brief    Open-loop replay of a trace annotated with injection cycles.
+ * @details
+ * Each trace line is "<cycle> <type> <address>", with types as in PIMLoadStoreTrace (LD, ST, PIM_*), and the cycles
+ * (counted from 0) must not decrease. A request is injected at its cycle divided by rate_scale, regardless of how
+ * many earlier requests are still in flight. If the memory system rejects a request, it and all later requests wait
+ * in the frontend, and the wait counts towards their latency.
+ *
+ * The latency of a read is split into its queueing delay, i.e., the cycles from its injection until the controller
+ * issues its first command, and its service time, i.e., the cycles from then on until its data returns. Writes and
+ * PIM requests complete without notifying the frontend, so only their injection delay is recorded. Running the same
+ * trace with different rate scales yields the load-latency curve of a memory system.
+ *
+ */
+class OpenLoopTrace : public IFrontEnd, public Implementation {
+  RAMULATOR_REGISTER_IMPLEMENTATION(IFrontEnd, OpenLoopTrace, "OpenLoopTrace", "Open-loop replay of a memory trace with injection cycles.")
+
+  private:
+    struct Trace {
+      Clk_t cycle;
+      int req_type;
+      Addr_t addr;
+    };
+    std::unique_ptr<TraceStream<Trace>> m_trace;
+    std::string m_trace_path;
+
+    double m_rate_scale = 1.0;
+    Clk_t m_last_trace_cycle = 0;
+
+    bool m_is_stalled = false;       // Whether the last request was rejected by the memory system
+
+    // Read latencies for the percentiles (grows to the largest latency)
+    std::vector<size_t> m_latency_histogram;
+
+    Clk_t m_first_injection_clk = -1;
+    Clk_t m_last_injection_clk = -1;
+    Clk_t m_last_accept_clk = -1;
+
+    size_t s_num_requests = 0;
+    size_t s_num_reads = 0;
+    Clk_t s_total_injection_delay = 0;
+    Clk_t s_total_queueing_delay = 0;
+    Clk_t s_total_service_time = 0;
+    Clk_t s_max_read_latency = 0;
+
+    double s_offered_load = 0;
+    double s_accepted_load = 0;
+    double s_avg_injection_delay = 0;
+    double s_avg_queueing_delay = 0;
+    double s_avg_service_time = 0;
+    double s_avg_read_latency = 0;
+    Clk_t s_p50_read_latency = 0;
+    Clk_t s_p90_read_latency = 0;
+    Clk_t s_p99_read_latency = 0;
+
+    Logger_t m_logger;
+
+  public:
+    void init() override {
+      std::string trace_path_str = param<std::string>("path").desc("Path to the timestamped trace file.").required();
+      m_clock_ratio = param<uint>("clock_ratio").required();
+      m_rate_scale = param<double>("rate_scale").desc("Factor the injection rate of the trace is scaled by (e.g., 2 injects twice as fast).").default_val(1.0);
+      int histogram_size = param<int>("latency_histogram_size").desc("Initial number of 1-cycle buckets of the read latency histogram used for the percentiles.").default_val(1 << 16);
+      int stream_buffer_size = param<int>("stream_buffer_size").desc("Number of parsed trace lines buffered ahead of the simulation.").default_val(1 << 16);
+
+      if (m_rate_scale <= 0) {
+        throw ConfigurationError("Invalid rate scale ({}) in {}!", m_rate_scale, get_name());
+      }
+      if (histogram_size <= 0) {
+        throw ConfigurationError("Invalid latency histogram size ({}) in {}!", histogram_size, get_name());
+      }
+      m_latency_histogram.resize(histogram_size, 0);
+
+      register_stat(s_num_requests).name("num_requests");
+      register_stat(s_num_reads).name("num_completed_reads");
+      register_stat(s_offered_load).name("offered_load").desc("Requests per cycle injected by the trace");
+      register_stat(s_accepted_load).name("accepted_load").desc("Requests per cycle accepted by the memory system");
+      register_stat(s_avg_injection_delay).name("avg_injection_delay").desc("Cycles a request waits in the frontend");
+      register_stat(s_avg_queueing_delay).name("avg_queueing_delay").desc("Cycles from the injection of a read until its first command");
+      register_stat(s_avg_service_time).name("avg_service_time").desc("Cycles from the first command of a read until its data returns");
+      register_stat(s_avg_read_latency).name("avg_read_latency");
+      register_stat(s_p50_read_latency).name("p50_read_latency");
+      register_stat(s_p90_read_latency).name("p90_read_latency");
+      register_stat(s_p99_read_latency).name("p99_read_latency");
+      register_stat(s_max_read_latency).name("max_read_latency");
+
+      m_logger = Logging::create_logger("OpenLoopTrace");
+      m_logger->info("Streaming trace file {} at {}x its injection rate ...", trace_path_str, m_rate_scale);
+      m_trace_path = trace_path_str;
+      m_trace = std::make_unique<TraceStream<Trace>>(
+        trace_path_str,
+        [trace_path_str](const std::string& line, Trace& trace) { return parse_line(trace_path_str, line, trace); },
+        stream_buffer_size
+      );
+    };
+
+    void setup(IFrontEnd* frontend, IMemorySystem* memory_system) override {
+      // The injection delay is measured in frontend cycles and the rest of the latency in memory cycles
+      if (int(m_clock_ratio) != memory_system->get_clock_ratio()) {
+        throw ConfigurationError("{} requires the frontend and the memory system to have the same clock ratio!", get_name());
+      }
+    };
+
+
+    void tick() override {
+      // Send the requests whose injection cycle has come, in trace order
+      bool req_full = false;
+      for (const Trace* t = m_trace->peek(); !req_full && t != nullptr; t = m_trace->peek()) {
+        if (t->cycle < m_last_trace_cycle) {
+          throw ConfigurationError("Trace {} is not ordered by cycle ({} after {})!", m_trace_path, t->cycle, m_last_trace_cycle);
+        }
+        Clk_t injection_clk = static_cast<Clk_t>(t->cycle / m_rate_scale);
+        if (injection_clk > m_clk) {
+          break;
+        }
+
+        if (send_trace(*t, injection_clk)) {
+          m_last_trace_cycle = t->cycle;
+          m_trace->pop();
+        } else {
+          req_full = true;
+        }
+      }
+      m_is_stalled = req_full;
+      // The trace cycles count from 0
+      m_clk++;
+    };
+
+    void finalize() override {
+      if (s_num_requests > 0) {
+        s_offered_load = double(s_num_requests) / (m_last_injection_clk - m_first_injection_clk + 1);
+        s_accepted_load = double(s_num_requests) / (m_last_accept_clk - m_first_injection_clk + 1);
+        s_avg_injection_delay = double(s_total_injection_delay) / s_num_requests;
+      }
+      if (s_num_reads > 0) {
+        s_avg_queueing_delay = double(s_total_queueing_delay) / s_num_reads;
+        s_avg_service_time = double(s_total_service_time) / s_num_reads;
+        s_avg_read_latency = s_avg_queueing_delay + s_avg_service_time;
+        s_p50_read_latency = get_latency_percentile(0.50);
+        s_p90_read_latency = get_latency_percentile(0.90);
+        s_p99_read_latency = get_latency_percentile(0.99);
+      }
+      IFrontEnd::finalize();
+    };
+
+
+  private:
+    /**
+     * @brief    Parses a trace line. Runs on the trace stream thread.
+     *
+     */
+    static bool parse_line(const std::string& file_path_str, const std::string& line, Trace& trace) {
+      std::vector<std::string> tokens;
+      tokenize(tokens, line, " ");
+
+      if (tokens.size() != 3) {
+        throw ConfigurationError("Trace {} format invalid!", file_path_str);
+      }
+
+      Clk_t cycle = std::stoll(tokens[0]);
+      if (cycle < 0) {
+        throw ConfigurationError("Trace {} format invalid!", file_path_str);
+      }
+
+      int req_type = get_trace_req_type(tokens[1]);
+      if (req_type < 0) {
+        throw ConfigurationError("Trace {} format invalid!", file_path_str);
+      }
+
+      Addr_t addr = -1;
+      if (tokens[2].compare(0, 2, "0x") == 0 || tokens[2].compare(0, 2, "0X") == 0) {
+        addr = std::stoll(tokens[2].substr(2), nullptr, 16);
+      } else {
+        addr = std::stoll(tokens[2]);
+      }
+      trace = {cycle, req_type, addr};
+      return true;
+    };
+
+    bool send_trace(const Trace& t, Clk_t injection_clk) {
+      Clk_t injection_delay = m_clk - injection_clk;
+
+      bool request_sent = false;
+      if (t.req_type == Request::Type::Read) {
+        request_sent = m_memory_system->send(Request(t.addr, t.req_type, 0, [this, injection_delay](Request& req) {
+          record_read(req, injection_delay);
+        }));
+      } else {
+        request_sent = m_memory_system->send({t.addr, t.req_type});
+      }
+
+      if (request_sent) {
+        if (s_num_requests == 0) {
+          m_first_injection_clk = injection_clk;
+        }
+        m_last_injection_clk = injection_clk;
+        m_last_accept_clk = m_clk;
+        s_num_requests++;
+        s_total_injection_delay += injection_delay;
+      }
+      return request_sent;
+    };
+
+    /**
+     * @brief    Splits the latency of a completed read into queueing delay and service time.
+     *
+     */
+    void record_read(const Request& req, Clk_t injection_delay) {
+      Clk_t arrive = req.arrive;
+      Clk_t issue = req.issue;
+      if (arrive < 0) {
+        // Forwarded from a buffered write, departing the cycle after it arrived
+        arrive = req.depart - 1;
+      }
+      if (issue < 0) {
+        issue = arrive;
+      }
+
+      Clk_t queueing_delay = injection_delay + (issue - arrive);
+      Clk_t service_time = req.depart - issue;
+      Clk_t latency = queueing_delay + service_time;
+
+      s_num_reads++;
+      s_total_queueing_delay += queueing_delay;
+      s_total_service_time += service_time;
+      s_max_read_latency = std::max(s_max_read_latency, latency);
+      if (size_t(latency) >= m_latency_histogram.size()) {
+        // Grow instead of clamping, so that the percentiles never saturate at the histogram size
+        m_latency_histogram.resize(std::max<size_t>(latency + 1, 2 * m_latency_histogram.size()), 0);
+      }
+      m_latency_histogram[latency]++;
+    };
+
+    Clk_t get_latency_percentile(double percentile) {
+      size_t rank = std::max<size_t>(1, std::ceil(percentile * s_num_reads));
+      size_t count = 0;
+      for (size_t latency = 0; latency < m_latency_histogram.size(); latency++) {
+        count += m_latency_histogram[latency];
+        if (count >= rank) {
+          return latency;
+        }
+      }
+      return s_max_read_latency;
+    };
+
+    bool is_stalled() override {
+      return m_is_stalled;
+    };
+
+    Clk_t get_num_idle_cycles() override {
+      const Trace* t = m_trace->peek();
+      if (m_is_stalled || t == nullptr) {
+        return IFrontEnd::get_num_idle_cycles();
+      }
+      // Nothing is sent until the injection cycle of the next request
+      Clk_t injection_clk = static_cast<Clk_t>(t->cycle / m_rate_scale);
+      return std::max<Clk_t>(injection_clk - m_clk, 0);
+    };
+
+    bool is_finished() override {
+      return m_trace->peek() == nullptr;
+    };
+};
+
+}        // namespace Ramulator
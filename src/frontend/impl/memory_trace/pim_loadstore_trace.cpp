@@ -1,8 +1,18 @@
 #include <filesystem>
 #include <iostream>
 #include <fstream>
+#include <cstring>
+#include <deque>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "frontend/frontend.h"
+#include "frontend/trace_stream.h"
+#include "frontend/trace_opcodes.h"
+#include "dram/dram.h"
 #include "base/exception.h"
 
 namespace Ramulator {
@@ -17,129 +27,277 @@ class PIMLoadStoreTrace : public IFrontEnd, public Implementation {
       int req_type;
       Addr_t addr;
     };
-    std::vector<Trace> m_trace;
+    std::unique_ptr<TraceStream<Trace>> m_trace;    // A text trace is parsed ahead of the simulation
+
+    /**
+     * @brief    Header of a binary trace (see trace_gen/convert_trace_to_binary.py).
+     * @details
+     * The header is followed by num_records little-endian 64-bit records. The low byte of a record is the request
+     * type (the same codes as in m_trace) and the upper 56 bits are the signed difference between the address of the
+     * record and the address of the previous record (0 for the first record).
+     * 
+     */
+    struct BinaryTraceHeader {
+      char magic[8];
+      uint32_t version;
+      uint32_t num_channels;      // The number of channels the trace was generated for (0 if unspecified)
+      uint64_t num_records;
+      uint64_t reserved;
+    };
+    static constexpr char BINARY_TRACE_MAGIC[8] = {'P', 'I', 'M', 'T', 'R', 'A', 'C', 'E'};
+    static constexpr uint32_t BINARY_TRACE_VERSION = 1;
+
+    // A binary trace is replayed straight from the memory-mapped file, one record at a time
+    void* m_mapped_trace = nullptr;
+    size_t m_mapped_size = 0;
+    const uint8_t* m_records = nullptr;
+    uint32_t m_num_trace_channels = 0;
+    Trace m_curr_record;
+    std::string m_trace_path;
 
     size_t m_trace_length = 0;
     size_t m_curr_trace_idx = 0;
 
     size_t m_trace_count = 0;
 
+    // Staging queues of the trace records per channel (disabled if the size is 0)
+    size_t m_channel_queue_size = 0;
+    std::vector<std::deque<Trace>> m_channel_queues;
+    size_t m_num_staged = 0;
+
+    bool m_is_stalled = false;       // Whether the last request was rejected by the memory system
+
     Logger_t m_logger;
 
   public:
     void init() override {
       std::string trace_path_str = param<std::string>("path").desc("Path to the load store trace file.").required();
       m_clock_ratio = param<uint>("clock_ratio").required();
+      int channel_queue_size = param<int>("channel_queue_size").desc("Number of trace records staged per channel, so that a full channel does not hold back the others (0: send in trace order).").default_val(0);
+      int stream_buffer_size = param<int>("stream_buffer_size").desc("Number of parsed text trace lines buffered ahead of the simulation.").default_val(1 << 16);
+
+      if (channel_queue_size < 0) {
+        throw ConfigurationError("Invalid channel queue size ({}) in {}!", channel_queue_size, get_name());
+      }
+      m_channel_queue_size = channel_queue_size;
 
       m_logger = Logging::create_logger("LoadStoreTrace");
       m_logger->info("Loading trace file {} ...", trace_path_str);
-      init_trace(trace_path_str);
-      m_logger->info("Loaded {} lines.", m_trace.size());
+      m_trace_path = trace_path_str;
+      if (is_binary_trace(trace_path_str)) {
+        init_binary_trace(trace_path_str);
+        m_logger->info("Mapped {} records.", m_trace_length);
+      } else {
+        m_trace = std::make_unique<TraceStream<Trace>>(
+          trace_path_str,
+          [trace_path_str](const std::string& line, Trace& trace) { return parse_line(trace_path_str, line, trace); },
+          stream_buffer_size
+        );
+      }
+    };
+
+    void setup(IFrontEnd* frontend, IMemorySystem* memory_system) override {
+      if (m_num_trace_channels == 0) {
+        return;
+      }
+      IDRAM* dram = memory_system->get_ifce<IDRAM>();
+      if (dram != nullptr && dram->get_level_size("channel") != int(m_num_trace_channels)) {
+        throw ConfigurationError("Trace {} was generated for {} channels, but the memory system has {}!",
+                                 m_trace_path, m_num_trace_channels, dram->get_level_size("channel"));
+      }
+    };
+
+    ~PIMLoadStoreTrace() {
+      if (m_mapped_trace != nullptr) {
+        munmap(m_mapped_trace, m_mapped_size);
+      }
     };
 
 
     void tick() override {
-      if (is_finished()) {
+      if (m_channel_queue_size == 0) {
+        // Requests are sent in trace order, so a rejected request holds back all the following ones
+        bool req_full = false;
+        for (const Trace* t = peek_trace(); !req_full && t != nullptr; t = peek_trace()) {
+          if (send_trace(*t)) {
+            pop_trace();
+          } else {
+            req_full = true;
+          }
+        }
+        m_is_stalled = req_full;
         return;
       }
-      bool req_full = false;
-      while(!req_full && !is_finished()) {
-        const Trace& t = m_trace[m_curr_trace_idx];
-        bool request_sent = false;
-        switch (t.req_type) {
-          case  0: request_sent = m_memory_system->send({t.addr, Request::Type::Read}); break;
-          case  1: request_sent = m_memory_system->send({t.addr, Request::Type::Write}); break;
-          case  4: request_sent = m_memory_system->send({t.addr, Request::Type::PIM_MAC_AB}); break;
-          case  5: request_sent = m_memory_system->send({t.addr, Request::Type::PIM_MAC_SB}); break;
-          case  6: request_sent = m_memory_system->send({t.addr, Request::Type::PIM_MAC_PB}); break;
-          case  7: request_sent = m_memory_system->send({t.addr, Request::Type::PIM_WR_GB}); break;
-          case  8: request_sent = m_memory_system->send({t.addr, Request::Type::PIM_MV_SB}); break;
-          case  9: request_sent = m_memory_system->send({t.addr, Request::Type::PIM_MV_GB}); break;
-          case 10: request_sent = m_memory_system->send({t.addr, Request::Type::PIM_SFM}); break;
-          case 11: request_sent = m_memory_system->send({t.addr, Request::Type::PIM_SET_MODEL}); break;
-          case 12: request_sent = m_memory_system->send({t.addr, Request::Type::PIM_SET_HEAD}); break;
-          case 13: request_sent = m_memory_system->send({t.addr, Request::Type::PIM_BARRIER}); break;
-          default:;
-        }
-        if (request_sent) {
-          m_curr_trace_idx = (m_curr_trace_idx + 1) % m_trace_length;
-          m_trace_count++;
-        }
-        else {
-          req_full = true;
+
+      // Each channel sends from its own queue until the memory system rejects its request, so that a full channel
+      // only holds back the requests to itself. Stop once neither staging nor sending makes progress.
+      bool has_progress = true;
+      while (has_progress) {
+        has_progress = stage_traces();
+        for (auto& queue : m_channel_queues) {
+          while (!queue.empty() && send_trace(queue.front())) {
+            queue.pop_front();
+            m_num_staged--;
+            has_progress = true;
+          }
         }
       }
+      m_is_stalled = !is_finished();
     };
 
 
   private:
-    void init_trace(const std::string& file_path_str) {
-      fs::path trace_path(file_path_str);
-      if (!fs::exists(trace_path)) {
-        throw ConfigurationError("Trace {} does not exist!", file_path_str);
+    /**
+     * @brief    Parses a text trace line. Runs on the trace stream thread.
+     * 
+     */
+    static bool parse_line(const std::string& file_path_str, const std::string& line, Trace& trace) {
+      std::vector<std::string> tokens;
+      tokenize(tokens, line, " ");
+
+      // TODO: Add line number here for better error messages
+      if (tokens.size() != 2) {
+        throw ConfigurationError("Trace {} format invalid!", file_path_str);
+      }
+
+      int req_type = get_trace_req_type(tokens[0]);
+      if (req_type < 0) {
+        throw ConfigurationError("Trace {} format invalid!", file_path_str);
+      }
+
+      Addr_t addr = -1;
+      if (tokens[1].compare(0, 2, "0x") == 0 || tokens[1].compare(0, 2, "0X") == 0) {
+        addr = std::stoll(tokens[1].substr(2), nullptr, 16);
+      } else {
+        addr = std::stoll(tokens[1]);
       }
+      trace = {req_type, addr};
+      return true;
+    };
+
+    bool is_binary_trace(const std::string& file_path_str) {
+      std::ifstream trace_file(file_path_str, std::ios::binary);
+      char magic[sizeof(BINARY_TRACE_MAGIC)] = {};
+      trace_file.read(magic, sizeof(magic));
+      return trace_file && std::memcmp(magic, BINARY_TRACE_MAGIC, sizeof(magic)) == 0;
+    };
 
-      std::ifstream trace_file(trace_path);
-      if (!trace_file.is_open()) {
+    void init_binary_trace(const std::string& file_path_str) {
+      int fd = open(file_path_str.c_str(), O_RDONLY);
+      if (fd < 0) {
         throw ConfigurationError("Trace {} cannot be opened!", file_path_str);
       }
+      struct stat file_stat;
+      if (fstat(fd, &file_stat) != 0 || size_t(file_stat.st_size) < sizeof(BinaryTraceHeader)) {
+        close(fd);
+        throw ConfigurationError("Trace {} format invalid!", file_path_str);
+      }
+      m_mapped_size = file_stat.st_size;
+      m_mapped_trace = mmap(nullptr, m_mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      close(fd);
+      if (m_mapped_trace == MAP_FAILED) {
+        m_mapped_trace = nullptr;
+        throw ConfigurationError("Trace {} cannot be mapped!", file_path_str);
+      }
+      madvise(m_mapped_trace, m_mapped_size, MADV_SEQUENTIAL);
 
-      std::string line;
-      while (std::getline(trace_file, line)) {
-        std::vector<std::string> tokens;
-        tokenize(tokens, line, " ");
+      BinaryTraceHeader header;
+      std::memcpy(&header, m_mapped_trace, sizeof(header));
+      if (header.version != BINARY_TRACE_VERSION) {
+        throw ConfigurationError("Trace {} has version {}, but only version {} is supported!", file_path_str, header.version, BINARY_TRACE_VERSION);
+      }
+      // Compare record counts rather than byte sizes, which a corrupt num_records could overflow
+      if (header.num_records != (m_mapped_size - sizeof(header)) / sizeof(uint64_t) || (m_mapped_size - sizeof(header)) % sizeof(uint64_t) != 0) {
+        throw ConfigurationError("Trace {} is truncated!", file_path_str);
+      }
 
-        // TODO: Add line number here for better error messages
-        if (tokens.size() != 2) {
-          throw ConfigurationError("Trace {} format invalid!", file_path_str);
-        }
+      m_records = static_cast<const uint8_t*>(m_mapped_trace) + sizeof(header);
+      m_num_trace_channels = header.num_channels;
+      m_trace_length = header.num_records;
+      if (m_trace_length != 0) {
+        decode_record();
+      }
+    };
+
+    /**
+     * @brief    Decodes the record at m_curr_trace_idx into m_curr_record, which holds the previous record.
+     * 
+     */
+    void decode_record() {
+      uint64_t record;
+      std::memcpy(&record, m_records + m_curr_trace_idx * sizeof(uint64_t), sizeof(record));
+      Addr_t prev_addr = (m_curr_trace_idx == 0) ? 0 : m_curr_record.addr;
 
-        int req_type = -1; 
-        if (tokens[0] == "LD") {
-          req_type = 0;
-        } else if (tokens[0] == "ST") {
-          req_type = 1;
-        } else if (tokens[0] == "PIM_MAC_AB") {
-          req_type = 4;
-        } else if (tokens[0] == "PIM_MAC_SB") {
-          req_type = 5;
-        } else if (tokens[0] == "PIM_MAC_PB") {
-          req_type = 6;
-        } else if (tokens[0] == "PIM_WR_GB") {
-          req_type = 7;
-        } else if (tokens[0] == "PIM_MV_SB") {
-          req_type = 8;
-        } else if (tokens[0] == "PIM_MV_GB") {
-          req_type = 9;
-        } else if (tokens[0] == "PIM_SFM") {
-          req_type = 10;
-        } else if (tokens[0] == "PIM_SET_MODEL") {
-          req_type = 11;
-        } else if (tokens[0] == "PIM_SET_HEAD") {
-          req_type = 12;
-        } else if (tokens[0] == "PIM_BARRIER") {
-          req_type = 13;
-        } else {
-          throw ConfigurationError("Trace {} format invalid!", file_path_str);
+      m_curr_record.req_type = record & 0xff;
+      m_curr_record.addr = prev_addr + (static_cast<int64_t>(record) >> 8);
+      if (!is_trace_req_type(m_curr_record.req_type)) {
+        throw ConfigurationError("Trace {} has an invalid request type at record {}!", m_trace_path, m_curr_trace_idx);
+      }
+    };
+
+    /**
+     * @brief    The next trace record that has not been sent or staged yet, or nullptr at the end of the trace.
+     * 
+     */
+    const Trace* peek_trace() {
+      if (m_records != nullptr) {
+        return (m_curr_trace_idx < m_trace_length) ? &m_curr_record : nullptr;
+      }
+      return m_trace->peek();
+    };
+
+    void pop_trace() {
+      if (m_records != nullptr) {
+        if (++m_curr_trace_idx < m_trace_length) {
+          decode_record();
         }
+      } else {
+        m_trace->pop();
+      }
+    };
 
-        Addr_t addr = -1;
-        if (tokens[1].compare(0, 2, "0x") == 0 | tokens[1].compare(0, 2, "0X") == 0) {
-          addr = std::stoll(tokens[1].substr(2), nullptr, 16);
-        } else {
-          addr = std::stoll(tokens[1]);
+    /**
+     * @brief    Moves trace records into the queues of their channels until the queue of the next record is full.
+     * 
+     */
+    bool stage_traces() {
+      bool has_staged = false;
+      for (const Trace* t = peek_trace(); t != nullptr; t = peek_trace()) {
+        Request req(t->addr, t->req_type);
+        int channel_id = m_memory_system->get_channel_id(req);
+        if (channel_id < 0) {
+          throw ConfigurationError("The memory system does not expose its channels, which per-channel queues in {} require!", get_name());
+        }
+        if (size_t(channel_id) >= m_channel_queues.size()) {
+          m_channel_queues.resize(channel_id + 1);
+        }
+        auto& queue = m_channel_queues[channel_id];
+        if (queue.size() >= m_channel_queue_size) {
+          break;
         }
-        m_trace.push_back({req_type, addr});
+        queue.push_back(*t);
+        m_num_staged++;
+        pop_trace();
+        has_staged = true;
       }
+      return has_staged;
+    };
 
-      trace_file.close();
+    bool send_trace(const Trace& t) {
+      // The request types of the trace are validated against the trace opcodes when they are parsed or decoded
+      bool request_sent = m_memory_system->send({t.addr, t.req_type});
+      if (request_sent) {
+        m_trace_count++;
+      }
+      return request_sent;
+    };
 
-      m_trace_length = m_trace.size();
+    bool is_stalled() override {
+      return m_is_stalled;
     };
 
-    // TODO: FIXME
     bool is_finished() override {
-      return m_trace_count >= m_trace_length; 
+      return m_num_staged == 0 && peek_trace() == nullptr;
     };
 };
 
@@ -3,6 +3,7 @@
 #include <fstream>
 
 #include "frontend/frontend.h"
+#include "frontend/trace_stream.h"
 #include "base/exception.h"
 
 namespace Ramulator {
@@ -17,10 +18,7 @@ class ReadWriteTrace : public IFrontEnd, public Implementation {
       bool is_write;
       AddrVec_t addr_vec;
     };
-    std::vector<Trace> m_trace;
-
-    size_t m_trace_length = 0;
-    size_t m_curr_trace_idx = 0;
+    std::unique_ptr<TraceStream<Trace>> m_trace;
 
     Logger_t m_logger;
 
@@ -29,65 +27,62 @@ class ReadWriteTrace : public IFrontEnd, public Implementation {
       std::string trace_path_str = param<std::string>("path").desc("Path to the load store trace file.").required();
       m_clock_ratio = param<uint>("clock_ratio").required();
 
+      int stream_buffer_size = param<int>("stream_buffer_size").desc("Number of parsed trace lines buffered ahead of the simulation.").default_val(1 << 16);
+
       m_logger = Logging::create_logger("ReadWriteTrace");
-      m_logger->info("Loading trace file {} ...", trace_path_str);
-      init_trace(trace_path_str);
-      m_logger->info("Loaded {} lines.", m_trace.size());      
+      m_logger->info("Streaming trace file {} ...", trace_path_str);
+      // The trace is replayed in a loop
+      m_trace = std::make_unique<TraceStream<Trace>>(
+        trace_path_str,
+        [trace_path_str](const std::string& line, Trace& trace) { return parse_line(trace_path_str, line, trace); },
+        stream_buffer_size, true
+      );
     };
 
 
     void tick() override {
-      const Trace& t = m_trace[m_curr_trace_idx];
-      m_memory_system->send({t.addr_vec, t.is_write ? Request::Type::Read : Request::Type::Write});
-      m_curr_trace_idx = (m_curr_trace_idx + 1) % m_trace_length;
+      const Trace* t = m_trace->peek();
+      if (t == nullptr) {
+        return;
+      }
+      m_memory_system->send({t->addr_vec, t->is_write ? Request::Type::Read : Request::Type::Write});
+      m_trace->pop();
     };
 
 
   private:
-    void init_trace(const std::string& file_path_str) {
-      fs::path trace_path(file_path_str);
-      if (!fs::exists(trace_path)) {
-        throw ConfigurationError("Trace {} does not exist!", file_path_str);
+    /**
+     * @brief    Parses a trace line. Runs on the trace stream thread.
+     * 
+     */
+    static bool parse_line(const std::string& file_path_str, const std::string& line, Trace& trace) {
+      std::vector<std::string> tokens;
+      tokenize(tokens, line, " ");
+
+      // TODO: Add line number here for better error messages
+      if (tokens.size() != 2) {
+        throw ConfigurationError("Trace {} format invalid!", file_path_str);
       }
 
-      std::ifstream trace_file(trace_path);
-      if (!trace_file.is_open()) {
-        throw ConfigurationError("Trace {} cannot be opened!", file_path_str);
+      bool is_write = false; 
+      if (tokens[0] == "R") {
+        is_write = false;
+      } else if (tokens[0] == "W") {
+        is_write = true;
+      } else {
+        throw ConfigurationError("Trace {} format invalid!", file_path_str);
       }
 
-      std::string line;
-      while (std::getline(trace_file, line)) {
-        std::vector<std::string> tokens;
-        tokenize(tokens, line, " ");
-
-        // TODO: Add line number here for better error messages
-        if (tokens.size() != 2) {
-          throw ConfigurationError("Trace {} format invalid!", file_path_str);
-        }
-
-        bool is_write = false; 
-        if (tokens[0] == "R") {
-          is_write = false;
-        } else if (tokens[0] == "W") {
-          is_write = true;
-        } else {
-          throw ConfigurationError("Trace {} format invalid!", file_path_str);
-        }
-
-        std::vector<std::string> addr_vec_tokens;
-        tokenize(addr_vec_tokens, tokens[1], ",");
-
-        AddrVec_t addr_vec;
-        for (const auto& token : addr_vec_tokens) {
-          addr_vec.push_back(std::stoll(token));
-        }
-
-        m_trace.push_back({is_write, addr_vec});
-      }
+      std::vector<std::string> addr_vec_tokens;
+      tokenize(addr_vec_tokens, tokens[1], ",");
 
-      trace_file.close();
+      AddrVec_t addr_vec;
+      for (const auto& token : addr_vec_tokens) {
+        addr_vec.push_back(std::stoll(token));
+      }
 
-      m_trace_length = m_trace.size();
+      trace = {is_write, addr_vec};
+      return true;
     };
 
     // TODO: FIXME
@@ -13,46 +13,43 @@ namespace Ramulator {
 
 namespace fs = std::filesystem;
 
-SimpleO3Core::Trace::Trace(std::string file_path_str) {
-  fs::path trace_path(file_path_str);
-  if (!fs::exists(trace_path)) {
-    throw ConfigurationError("Trace {} does not exist!", file_path_str);
-  }
-
-  std::ifstream trace_file(trace_path);
-  if (!trace_file.is_open()) {
-    throw ConfigurationError("Trace {} cannot be opened!", file_path_str);
-  }
-
-  std::string line;
-  while (std::getline(trace_file, line)) {
-    std::vector<std::string> tokens;
-    tokenize(tokens, line, " ");
+SimpleO3Core::Trace::Trace(std::string file_path_str): m_path(file_path_str) {
+  m_trace = std::make_unique<TraceStream<Inst>>(
+    file_path_str,
+    [file_path_str](const std::string& line, Inst& inst) { return parse_line(file_path_str, line, inst); },
+    STREAM_BUFFER_SIZE, true
+  );
+}
 
-    int num_tokens = tokens.size();
-    if (num_tokens != 2 & num_tokens != 3) {
-      throw ConfigurationError("Trace {} format invalid!", file_path_str);
-    }
-    int bubble_count = std::stoi(tokens[0]);
-    Addr_t load_addr = std::stoll(tokens[1]);
+bool SimpleO3Core::Trace::parse_line(const std::string& file_path_str, const std::string& line, Inst& inst) {
+  std::vector<std::string> tokens;
+  tokenize(tokens, line, " ");
 
-    bool has_store = num_tokens == 2 ? false : true; 
-    if (has_store) {
-      Addr_t store_addr = std::stoll(tokens[2]);
-      m_trace.push_back({bubble_count, load_addr, store_addr});
-    } else {
-      m_trace.push_back({bubble_count, load_addr, -1});
-    }
+  int num_tokens = tokens.size();
+  if (num_tokens != 2 & num_tokens != 3) {
+    throw ConfigurationError("Trace {} format invalid!", file_path_str);
   }
-
-  trace_file.close();
-  m_trace_length = m_trace.size();
+  int bubble_count = std::stoi(tokens[0]);
+  Addr_t load_addr = std::stoll(tokens[1]);
+
+  bool has_store = num_tokens == 2 ? false : true; 
+  if (has_store) {
+    Addr_t store_addr = std::stoll(tokens[2]);
+    inst = {bubble_count, load_addr, store_addr};
+  } else {
+    inst = {bubble_count, load_addr, -1};
+  }
+  return true;
 }
 
-const SimpleO3Core::Trace::Inst& SimpleO3Core::Trace::get_next_inst() {
-  const Inst& inst = m_trace[m_curr_trace_idx];
-  m_curr_trace_idx = (m_curr_trace_idx + 1) % m_trace_length;
-  return inst;
+SimpleO3Core::Trace::Inst SimpleO3Core::Trace::get_next_inst() {
+  const Inst* inst = m_trace->peek();
+  if (inst == nullptr) {
+    throw ConfigurationError("Trace {} is empty!", m_path);
+  }
+  Inst next_inst = *inst;
+  m_trace->pop();
+  return next_inst;
 }
 
 
@@ -7,6 +7,7 @@
 
 #include "base/type.h"
 #include "base/request.h"
+#include "frontend/trace_stream.h"
 #include "translation/translation.h"
 
 namespace Ramulator {
@@ -23,13 +24,15 @@ class SimpleO3Core : public Clocked<SimpleO3Core> {
       Addr_t store_addr = -1;
     };
   
-    std::vector<Inst> m_trace;
-    size_t m_trace_length = 0;
-    size_t m_curr_trace_idx = 0;
+    static constexpr size_t STREAM_BUFFER_SIZE = 1 << 16;   // Parsed trace lines buffered ahead of the core
+    std::string m_path;
+    std::unique_ptr<TraceStream<Inst>> m_trace;    // Replayed in a loop
+
+    static bool parse_line(const std::string& file_path_str, const std::string& line, Inst& inst);
 
     public:
       Trace(std::string file_path_str);
-      const Inst& get_next_inst();
+      Inst get_next_inst();
   };
 
   /**
@@ -0,0 +1,561 @@
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "frontend/frontend.h"
+#include "dram/dram.h"
+#include "base/exception.h"
+
+namespace Ramulator {
+
+/**
+ * @brief    Generates the PIM command stream of the AttAcc attention kernel while the simulation runs.
+ * @details
+ * Synthesizes the same WRGB/MAC/MVSB/SFM/MVGB/barrier stream as trace_gen/gen_trace_attacc_{bank,bg,buffer}.py,
+ * so no trace file has to be generated, stored, and parsed. The commands of one step of the kernel (e.g., the MACs
+ * between two barriers) are generated only when the previous step has been accepted by the memory system.
+ *
+ * The HBM organization (channels, pseudo channels, ranks, bank groups, banks, rows, columns, and the access
+ * granularity) is taken from the DRAM of the memory system, and the addresses follow the HBM3-PIM linear mapping
+ * (CH pCH Ra BG Ba Ro Co).
+ *
+ * Several sequence lengths can be swept in a single run. Each one runs the whole kernel on an idle memory system,
+ * and its latency is reported in the stats.
+ *
+ */
+class AttAccGenerator : public IFrontEnd, public Implementation {
+  RAMULATOR_REGISTER_IMPLEMENTATION(IFrontEnd, AttAccGenerator, "AttAccGenerator", "AttAcc attention kernel PIM command generator.")
+
+  private:
+    enum class Mapping {
+      Bank,           // Bank-level AttAcc: all-bank MACs
+      BankGroup,      // Bank group-level AttAcc: same-bank MACs
+      Buffer,         // Buffer-level AttAcc: per-bank MACs
+    };
+
+    struct Command {
+      int type_id;
+      Addr_t addr;
+    };
+
+    /**
+     * @brief    A step of the kernel schedule, expanded into commands when it is reached.
+     * @details
+     * [begin, end) is the range of commands (WRGB and MVGB) or of output elements (score MAC) of the step. The
+     * context MACs of output element begin are generated for ContextMAC.
+     *
+     */
+    struct Step {
+      enum Op {
+        ScoreWRGB, DummyMAC, ScoreMAC, ScoreMVSB, SFM, ContextMVGB, ContextMAC, ContextMVSB, Barrier,
+      } op;
+      int head = 0;
+      int begin = 0;
+      int end = 0;
+    };
+
+    // The heads mapped to the channels at the same time (i.e., an iteration of the kernel)
+    struct Head {
+      Addr_t key_addr;
+      Addr_t val_addr;
+      int num_channels;     // Channels that hold a head in this iteration
+    };
+
+    Mapping m_mapping = Mapping::BankGroup;
+    int m_dhead = -1;
+    int m_num_heads = -1;
+    int m_max_seq_len = -1;
+    int m_data_size = -1;
+    std::vector<int> m_seq_lens;
+
+    // HBM organization
+    int m_num_channels = -1;
+    int m_num_pchs = -1;
+    int m_num_ranks = -1;
+    int m_num_bgs = -1;
+    int m_num_banks = -1;
+    int m_num_cols = -1;
+    int m_num_macs = -1;    // Elements per column access
+
+    // Address granularity of each level
+    Addr_t m_col_size = -1;
+    Addr_t m_row_size = -1;
+    Addr_t m_bank_size = -1;
+    Addr_t m_bg_size = -1;
+    Addr_t m_rank_size = -1;
+    Addr_t m_ch_size = -1;
+
+    // Kernel dimensions for the current sequence length
+    int m_seq_len = -1;
+    int m_num_score_outputs = -1;     // Score elements per bank group (bank, bg) or pseudo channel (buffer)
+    int m_num_score_mvsbs = -1;       // MVSB groups of the score, one per 16 output elements
+    int m_num_dhead_cols = -1;        // Columns of dhead per MAC unit, i.e., score MACs per output element
+    int m_num_mvgb_cols = -1;         // MVGB commands per rank and bank group (bank, bg) or pseudo channel (buffer)
+    std::vector<Head> m_heads;
+
+    std::vector<Step> m_steps;
+    size_t m_step_idx = 0;
+    std::deque<Command> m_commands;   // The generated commands of the current step that have not been sent yet
+
+    size_t m_seq_len_idx = 0;
+    bool m_is_draining = false;       // Whether all commands of a sequence length were sent, waiting for them to finish
+    bool m_is_stalled = false;        // Whether the last request was rejected by the memory system
+    bool m_is_finished = false;
+    Clk_t m_seq_len_start_clk = 0;
+
+    std::vector<Clk_t> s_kernel_cycles;       // Cycles from the first request of each sequence length until the memory system drained
+    std::vector<size_t> s_num_requests;
+
+    Logger_t m_logger;
+
+  public:
+    void init() override {
+      m_clock_ratio = param<uint>("clock_ratio").required();
+      m_dhead = param<int>("dhead").desc("Head dimension.").default_val(128);
+      m_num_heads = param<int>("num_heads").desc("Number of attention heads per HBM.").default_val(64);
+      m_seq_lens = param<std::vector<int>>("seq_lens").desc("Sequence lengths (L) to run back to back. Lengths after the first wait for the memory system to drain.").default_val(std::vector<int>{2048});
+      m_max_seq_len = param<int>("max_seq_len").desc("Maximum sequence length the KV cache partitions are sized for.").default_val(4096);
+      m_data_size = param<int>("data_size").desc("Size of a data element in bytes.").default_val(2);
+
+      std::string mapping = param<std::string>("mapping").desc("AttAcc mapping (bank, bg, or buffer).").default_val("bg");
+      if (mapping == "bank") {
+        m_mapping = Mapping::Bank;
+      } else if (mapping == "bg") {
+        m_mapping = Mapping::BankGroup;
+      } else if (mapping == "buffer") {
+        m_mapping = Mapping::Buffer;
+      } else {
+        throw ConfigurationError("Unknown AttAcc mapping \"{}\" in {}!", mapping, get_name());
+      }
+
+      if (m_dhead <= 0 || m_num_heads <= 0 || m_max_seq_len <= 0 || m_data_size <= 0 || m_seq_lens.empty()) {
+        throw ConfigurationError("Invalid model parameters in {}!", get_name());
+      }
+      for (int seq_len : m_seq_lens) {
+        if (seq_len <= 0) {
+          throw ConfigurationError("Invalid sequence length ({}) in {}!", seq_len, get_name());
+        }
+      }
+
+      s_kernel_cycles.resize(m_seq_lens.size(), 0);
+      s_num_requests.resize(m_seq_lens.size(), 0);
+      register_stat(m_seq_lens).name("seq_lens");
+      register_stat(s_kernel_cycles).name("kernel_cycles");
+      register_stat(s_num_requests).name("num_requests");
+
+      m_logger = Logging::create_logger("AttAccGenerator");
+    };
+
+    void setup(IFrontEnd* frontend, IMemorySystem* memory_system) override {
+      IDRAM* dram = memory_system->get_ifce<IDRAM>();
+      if (dram == nullptr) {
+        throw ConfigurationError("{} requires a DRAM-based memory system!", get_name());
+      }
+
+      m_num_channels = dram->get_level_size("channel");
+      m_num_pchs = dram->get_level_size("pseudochannel");
+      m_num_ranks = dram->get_level_size("rank");
+      m_num_bgs = dram->get_level_size("bankgroup");
+      m_num_banks = dram->get_level_size("bank");
+      int num_rows = dram->get_level_size("row");
+      m_num_cols = dram->get_level_size("column");
+      if (m_num_channels <= 0 || m_num_pchs <= 0 || m_num_ranks <= 0 || m_num_bgs <= 0 || m_num_banks <= 0 || num_rows <= 0 || m_num_cols <= 0) {
+        throw ConfigurationError("{} requires an HBM organization (channel, pseudochannel, rank, bankgroup, bank, row, column)!", get_name());
+      }
+
+      m_col_size = dram->m_internal_prefetch_size * dram->m_channel_width / 8;
+      m_row_size = m_num_cols * m_col_size;
+      m_bank_size = num_rows * m_row_size;
+      m_bg_size = m_num_banks * m_bank_size;
+      m_rank_size = m_num_bgs * m_bg_size;
+      m_ch_size = m_num_pchs * m_num_ranks * m_rank_size;
+
+      m_num_macs = m_col_size / m_data_size;
+      if (m_num_macs <= 0) {
+        throw ConfigurationError("Data size ({}B) in {} is larger than a column ({}B)!", m_data_size, get_name(), m_col_size);
+      }
+
+      start_seq_len(0, 1);
+    };
+
+
+    void tick() override {
+      m_clk++;
+
+      if (m_is_draining) {
+        // Every sequence length starts on an idle memory system, so that its latency can be measured on its own
+        if (m_memory_system->is_pending()) {
+          return;
+        }
+        s_kernel_cycles[m_seq_len_idx] = m_clk - m_seq_len_start_clk;
+        start_seq_len(m_seq_len_idx + 1, m_clk);
+      }
+
+      while (!m_is_finished && !m_is_draining) {
+        if (m_commands.empty()) {
+          if (m_step_idx < m_steps.size()) {
+            expand_step(m_steps[m_step_idx++]);
+          } else if (m_seq_len_idx + 1 < m_seq_lens.size()) {
+            m_is_draining = true;
+          } else {
+            m_is_finished = true;
+          }
+          continue;
+        }
+
+        const Command& cmd = m_commands.front();
+        if (!m_memory_system->send({cmd.addr, cmd.type_id})) {
+          m_is_stalled = true;
+          return;
+        }
+        m_commands.pop_front();
+        s_num_requests[m_seq_len_idx]++;
+      }
+      m_is_stalled = false;
+    };
+
+    void finalize() override {
+      // The memory system finished the last sequence length in the last tick
+      if (m_is_finished) {
+        s_kernel_cycles[m_seq_len_idx] = m_clk + 1 - m_seq_len_start_clk;
+      }
+      IFrontEnd::finalize();
+    };
+
+    bool is_stalled() override {
+      return m_is_stalled || m_is_draining;
+    };
+
+    bool is_finished() override {
+      return m_is_finished;
+    };
+
+
+  private:
+    static int div_ceil(int a, int b) {
+      return (a + b - 1) / b;
+    };
+
+    /**
+     * @brief    Sets up the kernel for the sequence length at idx, which starts sending in the tick start_clk, and
+     *           builds its schedule.
+     *
+     */
+    void start_seq_len(size_t idx, Clk_t start_clk) {
+      m_seq_len_idx = idx;
+      m_seq_len = m_seq_lens[idx];
+      m_is_draining = false;
+      m_seq_len_start_clk = start_clk;
+
+      int num_partitions = (m_mapping == Mapping::Buffer) ? m_num_pchs : m_num_pchs * m_num_ranks * m_num_bgs;
+      m_num_score_outputs = div_ceil(m_seq_len, num_partitions);
+      m_num_score_mvsbs = div_ceil(m_num_score_outputs, 16);
+      m_num_dhead_cols = div_ceil(m_dhead, (m_mapping == Mapping::Bank) ? m_num_banks * m_num_macs : m_num_macs);
+      if (m_mapping == Mapping::Buffer) {
+        m_num_mvgb_cols = div_ceil(m_seq_len, m_num_pchs * m_num_macs);
+      } else {
+        m_num_mvgb_cols = div_ceil(m_seq_len, m_num_pchs * m_num_ranks * m_num_bgs * m_num_macs);
+      }
+
+      // The heads of an iteration are spread over the channels, and the K and V of an iteration are placed in the
+      // lower and upper half of the banks
+      Addr_t partition_size = div_ceil(m_max_seq_len * m_dhead, m_num_pchs * m_num_ranks * m_num_bgs * m_num_banks);
+      int num_itrs = div_ceil(m_num_heads, m_num_channels);
+      m_heads.clear();
+      for (int itr = 0; itr < num_itrs; itr++) {
+        int num_channels = (m_num_heads < (itr + 1) * m_num_channels) ? m_num_heads % m_num_channels : m_num_channels;
+        Addr_t key_addr = itr * partition_size;
+        m_heads.push_back({key_addr, key_addr + m_bank_size / 2, num_channels});
+      }
+
+      build_schedule();
+      m_step_idx = 0;
+
+      m_logger->info("Generating AttAcc ({}) for L = {}, dhead = {}, {} heads in {} iterations.",
+                     m_mapping == Mapping::Bank ? "bank" : (m_mapping == Mapping::BankGroup ? "bg" : "buffer"),
+                     m_seq_len, m_dhead, m_num_heads, num_itrs);
+    };
+
+    /**
+     * @brief    Builds the schedule of the kernel, which overlaps the phases of two heads at a time.
+     * @details
+     * Follows run_attention() of the trace generators step by step, including the context phase of the second
+     * head of a pair, which accesses the KV cache of the first head there.
+     *
+     */
+    void build_schedule() {
+      m_steps.clear();
+      int num_itrs = m_heads.size();
+      int score_len = m_num_score_mvsbs;
+      int context_len = m_num_dhead_cols;
+
+      for (int i = 0; i + 1 < num_itrs; i += 2) {
+        // Head0: Score, Head1: WRGB
+        add_step(Step::ScoreWRGB, i, 0, num_wrgbs(i));
+        if (i == 0) {
+          add_step(Step::DummyMAC, i);
+        }
+        add_step(Step::Barrier);
+        int wrgb_stride = num_wrgbs(i + 1) / score_len;
+        for (int j = 0; j <= score_len; j++) {
+          if (j != score_len) {
+            add_step(Step::ScoreMAC, i, j * 16, std::min((j + 1) * 16, m_num_score_outputs));
+          }
+          if (j != 0) {
+            add_step(Step::ScoreMVSB, i);
+          }
+          if (j != score_len) {
+            add_step(Step::ScoreWRGB, i + 1, j * wrgb_stride, std::min((j + 1) * wrgb_stride, num_wrgbs(i + 1)));
+            add_step(Step::Barrier);
+          }
+        }
+
+        // Head0: SoftMax, Head1: Score
+        add_overlapped_phase(score_len, i, [&](int j) {
+          add_step(Step::ScoreMAC, i + 1, j * 16, std::min((j + 1) * 16, m_num_score_outputs));
+        }, [&](int) {
+          add_step(Step::ScoreMVSB, i + 1);
+        });
+
+        // Head0: Context, Head1: SoftMax
+        add_overlapped_phase(context_len, i + 1, [&](int j) {
+          add_step(Step::ContextMAC, i, j);
+        }, [&](int) {
+          add_step(Step::ContextMVSB, i);
+        });
+
+        // Head1: Context
+        add_context_phase(i);
+      }
+
+      if (num_itrs % 2 != 0) {
+        int i = num_itrs - 1;
+
+        // Score
+        add_step(Step::ScoreWRGB, i, 0, num_wrgbs(i));
+        add_step(Step::Barrier);
+        for (int j = 0; j <= score_len; j++) {
+          if (j != score_len) {
+            add_step(Step::ScoreMAC, i, j * 16, std::min((j + 1) * 16, m_num_score_outputs));
+          }
+          if (j != 0) {
+            add_step(Step::ScoreMVSB, i);
+          }
+          if (j != score_len) {
+            add_step(Step::Barrier);
+          }
+        }
+
+        // SoftMax
+        add_step(Step::SFM, i);
+        add_step(Step::ContextMVGB, i, 0, num_mvgbs(i));
+        add_step(Step::Barrier);
+
+        // Context
+        add_context_phase(i);
+      }
+    };
+
+    /**
+     * @brief    A phase in which the MACs of one head overlap with the softmax of the other head, whose MVGBs are
+     *           spread over the second half of the phase.
+     *
+     */
+    template<typename MAC_t, typename MVSB_t>
+    void add_overlapped_phase(int length, int sfm_head, MAC_t add_mac, MVSB_t add_mvsb) {
+      int mvgb_start = length / 2;
+      int mvgb_stride = num_mvgbs(sfm_head) / div_ceil(length, 2);
+      for (int j = 0; j <= length; j++) {
+        if (j != length) {
+          add_mac(j);
+        }
+        if (j != 0) {
+          add_mvsb(j - 1);
+        }
+        if (j == 0) {
+          add_step(Step::SFM, sfm_head);
+        }
+        if (j != length) {
+          if (j >= mvgb_start) {
+            int begin = (j - mvgb_start) * mvgb_stride;
+            add_step(Step::ContextMVGB, sfm_head, begin, std::min(begin + mvgb_stride, num_mvgbs(sfm_head)));
+          }
+          add_step(Step::Barrier);
+        }
+      }
+    };
+
+    void add_context_phase(int head) {
+      int length = m_num_dhead_cols;
+      for (int j = 0; j <= length; j++) {
+        if (j != length) {
+          add_step(Step::ContextMAC, head, j);
+        }
+        if (j != 0) {
+          add_step(Step::ContextMVSB, head);
+        }
+        if (j != length) {
+          add_step(Step::Barrier);
+        }
+      }
+    };
+
+    void add_step(Step::Op op, int head = 0, int begin = 0, int end = 0) {
+      if ((op == Step::ScoreWRGB || op == Step::ContextMVGB || op == Step::ScoreMAC) && begin >= end) {
+        return;
+      }
+      m_steps.push_back({op, head, begin, end});
+    };
+
+    int num_wrgbs(int head) {
+      int num_cols = (m_mapping == Mapping::Bank) ? m_num_banks * m_num_dhead_cols : m_num_dhead_cols;
+      return num_cols * m_heads[head].num_channels;
+    };
+
+    int num_mvgbs(int head) {
+      int num_cols = (m_mapping == Mapping::Buffer) ? m_num_mvgb_cols : m_num_ranks * m_num_bgs * m_num_mvgb_cols;
+      return num_cols * m_heads[head].num_channels;
+    };
+
+    /**
+     * @brief    The address of the idx-th MAC operand of a head partition.
+     *
+     */
+    Addr_t mac_addr(Addr_t base_addr, int idx) {
+      if (m_mapping == Mapping::Bank) {
+        // All banks work in lockstep on the same column
+        return base_addr + idx * m_col_size;
+      }
+
+      int bg_idx = 0;
+      if (m_mapping == Mapping::Buffer) {
+        // Consecutive operands go to different bank groups (and ranks)
+        bg_idx = idx % (m_num_bgs * m_num_ranks);
+        idx /= m_num_bgs * m_num_ranks;
+        int bank_idx = idx % m_num_banks;
+        int num_bank_indices = idx / m_num_banks;
+        int col_idx = num_bank_indices % m_num_cols;
+        int row_idx = num_bank_indices / m_num_cols;
+        return base_addr + bg_idx * m_bg_size + bank_idx * m_bank_size + row_idx * m_row_size + col_idx * m_col_size;
+      }
+
+      int col_idx = idx % m_num_cols;
+      int num_cols = idx / m_num_cols;
+      int bank_idx = num_cols % m_num_banks;
+      int row_idx = num_cols / m_num_banks;
+      return base_addr + bank_idx * m_bank_size + row_idx * m_row_size + col_idx * m_col_size;
+    };
+
+    int mac_type() {
+      switch (m_mapping) {
+        case Mapping::Bank:       return Request::Type::PIM_MAC_AB;
+        case Mapping::BankGroup:  return Request::Type::PIM_MAC_SB;
+        default:                  return Request::Type::PIM_MAC_PB;
+      }
+    };
+
+    void add_command(int type_id, Addr_t addr) {
+      m_commands.push_back({type_id, addr});
+    };
+
+    void expand_step(const Step& step) {
+      const Head& head = m_heads[step.head];
+      int num_channels = head.num_channels;
+
+      switch (step.op) {
+        case Step::ScoreWRGB: {
+          // Write the query vector to the GEMV buffers
+          for (int k = step.begin; k < step.end; k++) {
+            int lch = k % num_channels;
+            int col_idx = (k / num_channels) % m_num_dhead_cols;
+            int bank_idx = (m_mapping == Mapping::Bank) ? (k / num_channels) / m_num_dhead_cols : 0;
+            add_command(Request::Type::PIM_WR_GB, head.key_addr + lch * m_ch_size + bank_idx * m_bank_size + col_idx);
+          }
+          break;
+        }
+        case Step::DummyMAC: {
+          for (int lch = 0; lch < num_channels; lch++) {
+            add_command(mac_type(), mac_addr(head.key_addr + lch * m_ch_size, 0));
+          }
+          break;
+        }
+        case Step::ScoreMAC: {
+          for (int n_idx = step.begin; n_idx < step.end; n_idx++) {
+            for (int k_idx = 0; k_idx < m_num_dhead_cols; k_idx++) {
+              int idx = k_idx + n_idx * m_num_dhead_cols;
+              for (int lch = 0; lch < num_channels; lch++) {
+                add_command(mac_type(), mac_addr(head.key_addr + lch * m_ch_size, idx));
+              }
+            }
+          }
+          break;
+        }
+        case Step::ScoreMVSB: {
+          if (m_mapping == Mapping::Buffer) {
+            add_channel_commands(Request::Type::PIM_MV_SB, head.key_addr, num_channels);
+            break;
+          }
+          for (int bg_idx = 0; bg_idx < m_num_bgs; bg_idx++) {
+            for (int rank = 0; rank < m_num_ranks; rank++) {
+              add_channel_commands(Request::Type::PIM_MV_SB, head.key_addr + rank * m_rank_size + bg_idx * m_bg_size, num_channels);
+            }
+          }
+          break;
+        }
+        case Step::SFM: {
+          add_channel_commands(Request::Type::PIM_SFM, 0, num_channels);
+          break;
+        }
+        case Step::ContextMVGB: {
+          // Move the softmax output to the GEMV buffers
+          for (int k = step.begin; k < step.end; k++) {
+            int lch = k % num_channels;
+            int col_idx = (k / num_channels) % m_num_mvgb_cols;
+            int bg_idx = (k / num_channels / m_num_mvgb_cols) % m_num_bgs;
+            int rank = (k / num_channels / m_num_mvgb_cols) / m_num_bgs;
+            if (m_mapping == Mapping::Buffer) {
+              bg_idx = rank = 0;
+            }
+            add_command(Request::Type::PIM_MV_GB, head.val_addr + lch * m_ch_size + rank * m_rank_size + bg_idx * m_bg_size + col_idx);
+          }
+          break;
+        }
+        case Step::ContextMAC: {
+          int n_idx = step.begin;
+          for (int k_idx = 0; k_idx < m_num_score_outputs; k_idx++) {
+            int idx = k_idx + n_idx * m_num_score_outputs;
+            for (int lch = 0; lch < num_channels; lch++) {
+              add_command(mac_type(), mac_addr(head.val_addr + lch * m_ch_size, idx));
+            }
+          }
+          break;
+        }
+        case Step::ContextMVSB: {
+          int num_banks = (m_mapping == Mapping::Bank) ? m_num_banks : 1;
+          int num_ranks = (m_mapping == Mapping::Buffer) ? 1 : m_num_ranks;
+          for (int bank_idx = 0; bank_idx < num_banks; bank_idx++) {
+            for (int rank = 0; rank < num_ranks; rank++) {
+              add_channel_commands(Request::Type::PIM_MV_SB, head.val_addr + rank * m_rank_size + bank_idx * m_bank_size, num_channels);
+            }
+          }
+          break;
+        }
+        case Step::Barrier: {
+          add_channel_commands(Request::Type::PIM_BARRIER, 0, m_num_channels);
+          break;
+        }
+      }
+    };
+
+    /**
+     * @brief    Sends a command to the same address in each of the first num_channels channels.
+     *
+     */
+    void add_channel_commands(int type_id, Addr_t addr, int num_channels) {
+      for (int lch = 0; lch < num_channels; lch++) {
+        add_command(type_id, addr + lch * m_ch_size);
+      }
+    };
+};
+
+}        // namespace Ramulator
@@ -0,0 +1,76 @@
+#ifndef     RAMULATOR_FRONTEND_TRACE_OPCODES_H
+#define     RAMULATOR_FRONTEND_TRACE_OPCODES_H
+
+#include <array>
+#include <string_view>
+#include <unordered_map>
+
+#include "base/request.h"
+
+namespace Ramulator {
+
+/**
+ * @brief    The opcodes of the PIM trace formats and the request types they stand for.
+ *
+ * @details
+ * The text trace frontends parse opcodes through this table, and binary traces store the request types directly.
+ * trace_gen/convert_trace_to_binary.py keeps a copy of it (REQ_TYPES) that must match.
+ *
+ */
+struct TraceOpcode {
+  std::string_view name;
+  int req_type;
+};
+
+inline constexpr std::array<TraceOpcode, 12> TRACE_OPCODES = {{
+  {"LD",            Request::Type::Read},
+  {"ST",            Request::Type::Write},
+  {"PIM_MAC_AB",    Request::Type::PIM_MAC_AB},
+  {"PIM_MAC_SB",    Request::Type::PIM_MAC_SB},
+  {"PIM_MAC_PB",    Request::Type::PIM_MAC_PB},
+  {"PIM_WR_GB",     Request::Type::PIM_WR_GB},
+  {"PIM_MV_SB",     Request::Type::PIM_MV_SB},
+  {"PIM_MV_GB",     Request::Type::PIM_MV_GB},
+  {"PIM_SFM",       Request::Type::PIM_SFM},
+  {"PIM_SET_MODEL", Request::Type::PIM_SET_MODEL},
+  {"PIM_SET_HEAD",  Request::Type::PIM_SET_HEAD},
+  {"PIM_BARRIER",   Request::Type::PIM_BARRIER},
+}};
+
+/**
+ * @brief    The request type of a trace opcode, or -1 if the opcode is unknown.
+ *
+ */
+inline int get_trace_req_type(std::string_view opcode) {
+  static const std::unordered_map<std::string_view, int> req_types = [] {
+    std::unordered_map<std::string_view, int> req_types;
+    for (const TraceOpcode& opcode : TRACE_OPCODES) {
+      req_types.emplace(opcode.name, opcode.req_type);
+    }
+    return req_types;
+  }();
+
+  auto it = req_types.find(opcode);
+  return (it == req_types.end()) ? -1 : it->second;
+};
+
+/**
+ * @brief    Whether a request type (e.g., the type byte of a binary trace record) stands for a trace opcode.
+ *
+ */
+inline bool is_trace_req_type(int req_type) {
+  static constexpr std::array<bool, 256> is_valid = [] {
+    std::array<bool, 256> is_valid = {};
+    for (const TraceOpcode& opcode : TRACE_OPCODES) {
+      is_valid[opcode.req_type] = true;
+    }
+    return is_valid;
+  }();
+
+  return req_type >= 0 && req_type < int(is_valid.size()) && is_valid[req_type];
+};
+
+}        // namespace Ramulator
+
+
+#endif   // RAMULATOR_FRONTEND_TRACE_OPCODES_H
@@ -0,0 +1,190 @@
+#ifndef     RAMULATOR_FRONTEND_TRACE_STREAM_H
+#define     RAMULATOR_FRONTEND_TRACE_STREAM_H
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/exception.h"
+
+namespace Ramulator {
+
+/**
+ * @brief    A text trace that is parsed on a background thread while it is being replayed.
+ *
+ * @details
+ * A producer thread reads the trace in chunks of lines, parses every line with the supplied parser, and pushes the
+ * records into a lock-free single-producer/single-consumer ring. The simulation thread consumes the records in
+ * trace order through peek() and pop(). Memory is bounded by the ring capacity regardless of the trace length, and
+ * parsing overlaps with the simulation.
+ *
+ * The parser returns false for lines that do not carry a record and throws for malformed lines. Such an exception
+ * is rethrown to the simulation thread once it has consumed every record before the malformed line.
+ *
+ * A looping stream restarts from the beginning of the trace when it reaches the end of the file, i.e., it never
+ * ends unless the trace holds no record.
+ */
+template<typename Record_t>
+class TraceStream {
+  public:
+    using Parser_t = std::function<bool(const std::string& line, Record_t& record)>;
+
+  private:
+    static constexpr size_t CHUNK_SIZE = 256;       // Records the producer parses before publishing them
+    static constexpr int SPIN_ITERATIONS = 4096;
+    static constexpr auto PRODUCER_SLEEP = std::chrono::microseconds(50);
+
+    std::string m_path;
+    Parser_t m_parser;
+    bool m_is_looping;
+
+    std::vector<Record_t> m_ring;
+    size_t m_mask = 0;
+
+    alignas(64) std::atomic<size_t> m_head = 0;     // The next record to consume, written by the consumer
+    alignas(64) std::atomic<size_t> m_tail = 0;     // The next record to produce, written by the producer
+    alignas(64) size_t m_cached_tail = 0;           // The consumer's last view of m_tail
+    std::atomic<bool> m_is_done = false;            // The producer has published its last record
+    std::atomic<bool> m_stop = false;
+    std::exception_ptr m_error;                     // Set by the producer before m_is_done
+
+    std::thread m_producer;
+
+  public:
+    /**
+     * @brief    Opens the trace and starts parsing it. capacity (the stream_buffer_size of the frontends) must be
+     *           positive and is rounded up to a power of two.
+     *
+     */
+    TraceStream(const std::string& path, Parser_t parser, int capacity, bool is_looping = false):
+    m_path(path), m_parser(std::move(parser)), m_is_looping(is_looping) {
+      if (capacity <= 0) {
+        throw ConfigurationError("Invalid stream buffer size ({}) for trace {}!", capacity, path);
+      }
+      if (!std::filesystem::exists(path)) {
+        throw ConfigurationError("Trace {} does not exist!", path);
+      }
+      std::ifstream trace_file(path);
+      if (!trace_file.is_open()) {
+        throw ConfigurationError("Trace {} cannot be opened!", path);
+      }
+
+      size_t ring_size = CHUNK_SIZE;
+      while (ring_size < size_t(capacity)) {
+        ring_size <<= 1;
+      }
+      m_ring.resize(ring_size);
+      m_mask = ring_size - 1;
+
+      m_producer = std::thread([this] { produce(); });
+    };
+
+    ~TraceStream() {
+      m_stop.store(true, std::memory_order_relaxed);
+      m_producer.join();
+    };
+
+    TraceStream(const TraceStream&) = delete;
+    TraceStream& operator=(const TraceStream&) = delete;
+
+    /**
+     * @brief    The next record of the trace, or nullptr if the trace has ended. Waits for the producer if it lags
+     *           behind.
+     *
+     */
+    const Record_t* peek() {
+      size_t head = m_head.load(std::memory_order_relaxed);
+      if (head == m_cached_tail && !wait_for_records(head)) {
+        return nullptr;
+      }
+      return &m_ring[head & m_mask];
+    };
+
+    /**
+     * @brief    Consumes the record returned by the last peek().
+     *
+     */
+    void pop() {
+      m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    };
+
+  private:
+    bool wait_for_records(size_t head) {
+      for (int i = 0; ; i++) {
+        m_cached_tail = m_tail.load(std::memory_order_acquire);
+        if (m_cached_tail != head) {
+          return true;
+        }
+        if (m_is_done.load(std::memory_order_acquire)) {
+          // The last records may have been published right before the producer finished
+          m_cached_tail = m_tail.load(std::memory_order_acquire);
+          if (m_cached_tail != head) {
+            return true;
+          }
+          if (m_error) {
+            std::rethrow_exception(m_error);
+          }
+          return false;
+        }
+        if (i >= SPIN_ITERATIONS) {
+          std::this_thread::yield();
+        }
+      }
+    };
+
+    void produce() {
+      size_t tail = 0;
+      try {
+        std::ifstream trace_file(m_path);
+        std::string line;
+        size_t num_records_in_pass = 0;
+        while (!m_stop.load(std::memory_order_relaxed)) {
+          if (!std::getline(trace_file, line)) {
+            if (!m_is_looping || num_records_in_pass == 0) {
+              break;
+            }
+            trace_file.clear();
+            trace_file.seekg(0);
+            num_records_in_pass = 0;
+            continue;
+          }
+
+          Record_t record;
+          if (!m_parser(line, record)) {
+            continue;
+          }
+
+          // Wait until the consumer frees a slot, publishing what we have so that it can make progress
+          while (tail - m_head.load(std::memory_order_acquire) == m_ring.size()) {
+            m_tail.store(tail, std::memory_order_release);
+            if (m_stop.load(std::memory_order_relaxed)) {
+              return;
+            }
+            std::this_thread::sleep_for(PRODUCER_SLEEP);
+          }
+
+          m_ring[tail & m_mask] = std::move(record);
+          tail++;
+          num_records_in_pass++;
+          if (tail % CHUNK_SIZE == 0) {
+            m_tail.store(tail, std::memory_order_release);
+          }
+        }
+      } catch (...) {
+        m_error = std::current_exception();
+      }
+      m_tail.store(tail, std::memory_order_release);
+      m_is_done.store(true, std::memory_order_release);
+    };
+};
+
+}        // namespace Ramulator
+
+
+#endif   // RAMULATOR_FRONTEND_TRACE_STREAM_H
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 
 #include <argparse/argparse.hpp>
@@ -96,13 +97,37 @@ int main(int argc, char* argv[]) {
 
   int tick_mult = frontend_tick * mem_tick;
 
+  // Fast-forwarding skips the frontend ticks together with the memory system ticks, so both must run at the same rate
+  bool fast_forward = memory_system->is_fast_forward_enabled();
+  if (fast_forward && tick_mult != 1) {
+    spdlog::warn("Fast-forwarding requires the frontend and the memory system to have the same clock ratio. Disabled!");
+    fast_forward = false;
+  }
+
   for (uint64_t i = 0;; i++) {
     if (((i % tick_mult) % mem_tick) == 0) {
       frontend->tick();
     }
 
+    // Skip the cycles in which neither the frontend nor the memory system can make any progress
+    if (fast_forward && (!frontend->is_finished() || memory_system->is_pending())) {
+      Ramulator::Clk_t num_idle_cycles = std::min(frontend->get_num_idle_cycles(), memory_system->get_num_idle_cycles());
+      if (num_idle_cycles > 0) {
+        frontend->fast_forward(num_idle_cycles);
+        memory_system->fast_forward(num_idle_cycles);
+        i += num_idle_cycles;
+      }
+    }
+
     if ((i % tick_mult) % frontend_tick == 0) {
       memory_system->tick();
+
+      // The memory system may run ahead on its own, so the frontend skips the same cycles to keep its clock in step
+      Ramulator::Clk_t num_skipped_cycles = memory_system->get_num_skipped_cycles();
+      if (num_skipped_cycles > 0) {
+        frontend->fast_forward(num_skipped_cycles);
+        i += num_skipped_cycles;
+      }
     }
 
     if (frontend->is_finished() & !memory_system->is_pending()) {
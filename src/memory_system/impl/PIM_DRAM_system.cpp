@@ -1,8 +1,12 @@
+#include <limits>
+#include <memory>
+
 #include "memory_system/memory_system.h"
 #include "translation/translation.h"
 #include "dram_controller/controller.h"
 #include "addr_mapper/addr_mapper.h"
 #include "dram/dram.h"
+#include "base/worker_pool.h"
 
 namespace Ramulator {
 
@@ -15,6 +19,14 @@ class PIMDRAMSystem final : public IMemorySystem, public Implementation {
     IAddrMapper*  m_addr_mapper;
     std::vector<IDRAMController*> m_controllers;
 
+    int m_num_threads = 1;
+    std::unique_ptr<WorkerPool> m_worker_pool;    // Runs the per-channel jobs on disjoint subsets of the channels in parallel (nullptr in serial mode)
+    std::function<void(int)> m_channel_job;       // The job currently run by the worker pool for each channel
+
+    bool m_time_warp = false;
+    int m_blocked_channel = -1;                   // The channel that rejected the last request from the frontend (-1 if none)
+    Clk_t m_num_skipped_cycles = 0;               // The cycles the channels ran ahead while draining in the last tick
+
   public:
     int s_num_read_requests = 0;
     int s_num_write_requests = 0;
@@ -28,6 +40,7 @@ class PIMDRAMSystem final : public IMemorySystem, public Implementation {
     int s_num_pim_set_model_requests = 0;
     int s_num_pim_set_head_requests = 0;
     int s_num_other_requests = 0;
+    size_t s_num_forwarded_reads = 0;
 
 
   public:
@@ -47,6 +60,15 @@ class PIMDRAMSystem final : public IMemorySystem, public Implementation {
       }
 
       m_clock_ratio = param<uint>("clock_ratio").required();
+      m_fast_forward = param<bool>("fast_forward").desc("Skip over cycles in which no controller can make progress.").default_val(false);
+      m_num_threads = param<int>("num_threads").desc("Number of threads ticking the channel controllers in parallel (1 = serial).").default_val(1);
+      if (m_num_threads < 1) {
+        throw ConfigurationError("Invalid number of threads ({}) in {}!", m_num_threads, get_name());
+      }
+      m_time_warp = param<bool>("time_warp").desc("Simulate the channels decoupled from each other. Requires a frontend that does not wait on request callbacks.").default_val(false);
+      if (m_time_warp && !m_dram->has_channel_clocks()) {
+        throw ConfigurationError("Time warp in {} requires a DRAM device with per-channel clocks!", get_name());
+      }
 
       register_stat(m_clk).name("memory_system_cycles");
       register_stat(s_num_read_requests).name("total_num_read_requests");
@@ -61,17 +83,52 @@ class PIMDRAMSystem final : public IMemorySystem, public Implementation {
       register_stat(s_num_pim_set_model_requests).name("total_num_pim_set_model_requests");
       register_stat(s_num_pim_set_head_requests).name("total_num_pim_set_head_requests");
       register_stat(s_num_other_requests).name("total_num_other_requests");
+      register_stat(s_num_forwarded_reads).name("total_num_forwarded_reads");
     };
 
-    void setup(IFrontEnd* frontend, IMemorySystem* memory_system) override { }
+    void setup(IFrontEnd* frontend, IMemorySystem* memory_system) override {
+      // Skipping the drained cycles of the frontend together with the memory system requires both to tick at the same rate
+      if (m_time_warp && (frontend->get_clock_ratio() != 1 || m_clock_ratio != 1)) {
+        throw ConfigurationError("Time warp in {} requires the frontend and the memory system to have a clock ratio of 1!", get_name());
+      }
+
+      // The channels do not share any device or controller state, so each worker can tick its own subset of them.
+      // Read callbacks may touch state shared by all channels (e.g., in the frontend), so they run on this thread.
+      int num_workers = std::min<int>(m_num_threads, m_controllers.size());
+      if (num_workers > 1) {
+        for (auto controller : m_controllers) {
+          controller->m_defer_callbacks = true;
+        }
+        m_worker_pool = std::make_unique<WorkerPool>(num_workers, [this, num_workers](int worker_id) {
+          for (size_t i = worker_id; i < m_controllers.size(); i += num_workers) {
+            m_channel_job(i);
+          }
+        });
+      }
+    }
+
+    int get_channel_id(Request& req) override {
+      m_addr_mapper->apply(req);
+      return req.addr_vec[0];
+    };
 
     bool send(Request req) override {
       m_addr_mapper->apply(req);
       int channel_id = req.addr_vec[0];
+
+      // A lagging channel has to catch up before it can accept new requests.
+      // All lagging channels catch up together so that this can be done in parallel.
+      if (m_time_warp && m_controllers[channel_id]->get_clk() != m_clk) {
+        sync_channels();
+      }
+
+      // The controller takes over (moves from) the request on success
+      int type_id = req.type_id;
       bool is_success = m_controllers[channel_id]->send(req);
+      m_blocked_channel = is_success ? -1 : channel_id;
 
       if (is_success) {
-        switch (req.type_id) {
+        switch (type_id) {
           case Request::Type::Read: {
             s_num_read_requests++;
             break;
@@ -131,10 +188,35 @@ class PIMDRAMSystem final : public IMemorySystem, public Implementation {
     
     void tick() override {
       m_clk++;
-      m_dram->tick();
+      m_num_skipped_cycles = 0;
+      if (!m_time_warp) {
+        m_dram->tick();
+        for_each_channel([this](int channel_id) {
+          m_controllers[channel_id]->tick();
+        });
+      } else if (m_frontend->is_finished()) {
+        // No new requests will arrive, so every channel can run on its own until it finishes.
+        // The simulation loop makes the frontend skip the same cycles (see get_num_skipped_cycles()).
+        Clk_t drain_start_clk = m_clk;
+        drain_channels();
+        m_num_skipped_cycles = m_clk - drain_start_clk;
+      } else if (m_blocked_channel != -1) {
+        // Only the channel the frontend is waiting on has to be kept up to date, the others lag behind
+        run_channel_until(m_blocked_channel, m_clk);
+        deliver_deferred_reads();
+      } else if (m_frontend->is_stalled()) {
+        // The frontend waits on the memory system without being blocked by a channel (e.g., until all channels are
+        // idle), so no send() will make the lagging channels catch up. Keep all of them up to date instead.
+        sync_channels();
+      }
+    };
+
+    void finalize() override {
+      // The controllers count their forwarded reads, only the memory system prints its stats
       for (auto controller : m_controllers) {
-        controller->tick();
+        s_num_forwarded_reads += controller->get_num_forwarded_reads();
       }
+      IMemorySystem::finalize();
     };
 
     float get_tCK() override {
@@ -148,10 +230,149 @@ class PIMDRAMSystem final : public IMemorySystem, public Implementation {
     bool is_pending() override {
       bool is_pending = false;
       for (auto controller : m_controllers) {
-        is_pending |= controller->is_pending();
+        // We do not know yet whether a lagging channel is done
+        is_pending |= controller->get_clk() != m_clk || controller->is_pending();
       }
       return is_pending;
     };
+
+    Clk_t get_num_idle_cycles() override {
+      Clk_t num_idle_cycles = std::numeric_limits<Clk_t>::max();
+      bool has_synced_channel = false;
+      for (auto controller : m_controllers) {
+        // Lagging channels fast-forward on their own when they catch up
+        if (controller->get_clk() != m_clk) {
+          continue;
+        }
+        // The controllers are ticked in lockstep, so the next tick happens at clk + 1
+        num_idle_cycles = std::min(num_idle_cycles, controller->get_next_event_clk() - (controller->get_clk() + 1));
+        has_synced_channel = true;
+      }
+      return has_synced_channel ? num_idle_cycles : 0;
+    };
+
+    Clk_t get_num_skipped_cycles() override {
+      return m_num_skipped_cycles;
+    };
+
+    void fast_forward(Clk_t num_cycles) override {
+      if (!m_time_warp) {
+        m_dram->fast_forward(num_cycles);
+        for (auto controller : m_controllers) {
+          controller->fast_forward(num_cycles);
+        }
+      } else {
+        for (size_t channel_id = 0; channel_id < m_controllers.size(); channel_id++) {
+          if (m_controllers[channel_id]->get_clk() == m_clk) {
+            m_dram->advance_channel_clk(channel_id, num_cycles);
+            m_controllers[channel_id]->fast_forward(num_cycles);
+          }
+        }
+      }
+      m_clk += num_cycles;
+    };
+
+  private:
+    /**
+     * @brief    Calls the deferred read callbacks of all channels in channel order.
+     * 
+     */
+    void deliver_deferred_reads() {
+      for (auto controller : m_controllers) {
+        controller->deliver_deferred_reads();
+      }
+    };
+
+    /**
+     * @brief    Runs the job for every channel, in parallel if a worker pool is available.
+     * 
+     */
+    void for_each_channel(std::function<void(int)> job) {
+      if (m_worker_pool) {
+        m_channel_job = std::move(job);
+        m_worker_pool->run();
+        deliver_deferred_reads();
+      } else {
+        for (size_t channel_id = 0; channel_id < m_controllers.size(); channel_id++) {
+          job(channel_id);
+        }
+      }
+    };
+
+    /**
+     * @brief    Advances a single channel (its controller and its part of the device) by one tick,
+     *           or by up to max_cycles idle cycles at once if fast-forwarding is enabled.
+     * 
+     */
+    void step_channel(int channel_id, Clk_t max_cycles) {
+      IDRAMController* controller = m_controllers[channel_id];
+
+      Clk_t num_idle_cycles = 0;
+      if (m_fast_forward) {
+        num_idle_cycles = std::min(controller->get_next_event_clk() - (controller->get_clk() + 1), max_cycles);
+      }
+
+      if (num_idle_cycles > 0) {
+        m_dram->advance_channel_clk(channel_id, num_idle_cycles);
+        controller->fast_forward(num_idle_cycles);
+      } else {
+        m_dram->advance_channel_clk(channel_id, 1);
+        controller->tick();
+      }
+    };
+
+    /**
+     * @brief    Advances a single channel until its clock reaches the given clock cycle.
+     * 
+     */
+    void run_channel_until(int channel_id, Clk_t clk) {
+      while (m_controllers[channel_id]->get_clk() < clk) {
+        step_channel(channel_id, clk - m_controllers[channel_id]->get_clk());
+      }
+    };
+
+    /**
+     * @brief    Lets all lagging channels catch up with the memory system clock.
+     * 
+     */
+    void sync_channels() {
+      for_each_channel([this](int channel_id) {
+        run_channel_until(channel_id, m_clk);
+      });
+    };
+
+    /**
+     * @brief    Runs all channels until they are done with all their requests.
+     * @details
+     * Each channel first runs on its own until it becomes idle. All channels then catch up with the one
+     * that finished last. If some channel became busy again in the meantime (e.g., because of refresh),
+     * this is repeated. The memory system clock ends up at the first clock cycle at which all channels
+     * are idle, which is the same cycle at which the lockstep simulation would have stopped.
+     * 
+     */
+    void drain_channels() {
+      while (true) {
+        for_each_channel([this](int channel_id) {
+          run_channel_until(channel_id, m_clk);
+          while (m_controllers[channel_id]->is_pending()) {
+            step_channel(channel_id, std::numeric_limits<Clk_t>::max());
+          }
+        });
+
+        for (auto controller : m_controllers) {
+          m_clk = std::max(m_clk, controller->get_clk());
+        }
+        sync_channels();
+
+        bool is_pending = false;
+        for (auto controller : m_controllers) {
+          is_pending |= controller->is_pending();
+        }
+        if (!is_pending) {
+          break;
+        }
+      }
+    };
 };
   
 }   // namespace 
@@ -1,3 +1,5 @@
+#include <limits>
+
 #include "memory_system/memory_system.h"
 #include "translation/translation.h"
 #include "dram_controller/controller.h"
@@ -19,6 +21,7 @@ class GenericDRAMSystem final : public IMemorySystem, public Implementation {
     int s_num_read_requests = 0;
     int s_num_write_requests = 0;
     int s_num_other_requests = 0;
+    size_t s_num_forwarded_reads = 0;
 
 
   public:
@@ -38,22 +41,31 @@ class GenericDRAMSystem final : public IMemorySystem, public Implementation {
       }
 
       m_clock_ratio = param<uint>("clock_ratio").required();
+      m_fast_forward = param<bool>("fast_forward").desc("Skip over cycles in which no controller can make progress.").default_val(false);
 
       register_stat(m_clk).name("memory_system_cycles");
       register_stat(s_num_read_requests).name("total_num_read_requests");
       register_stat(s_num_write_requests).name("total_num_write_requests");
       register_stat(s_num_other_requests).name("total_num_other_requests");
+      register_stat(s_num_forwarded_reads).name("total_num_forwarded_reads");
     };
 
     void setup(IFrontEnd* frontend, IMemorySystem* memory_system) override { }
 
+    int get_channel_id(Request& req) override {
+      m_addr_mapper->apply(req);
+      return req.addr_vec[0];
+    };
+
     bool send(Request req) override {
       m_addr_mapper->apply(req);
       int channel_id = req.addr_vec[0];
+      // The controller takes over (moves from) the request on success
+      int type_id = req.type_id;
       bool is_success = m_controllers[channel_id]->send(req);
 
       if (is_success) {
-        switch (req.type_id) {
+        switch (type_id) {
           case Request::Type::Read: {
             s_num_read_requests++;
             break;
@@ -80,6 +92,14 @@ class GenericDRAMSystem final : public IMemorySystem, public Implementation {
       }
     };
 
+    void finalize() override {
+      // The controllers count their forwarded reads, only the memory system prints its stats
+      for (auto controller : m_controllers) {
+        s_num_forwarded_reads += controller->get_num_forwarded_reads();
+      }
+      IMemorySystem::finalize();
+    };
+
     float get_tCK() override {
       return m_dram->m_timing_vals("tCK_ps") / 1000.0f;
     };
@@ -95,6 +115,23 @@ class GenericDRAMSystem final : public IMemorySystem, public Implementation {
       }
       return is_pending;
     };
+
+    Clk_t get_num_idle_cycles() override {
+      Clk_t num_idle_cycles = std::numeric_limits<Clk_t>::max();
+      for (auto controller : m_controllers) {
+        // The controllers are ticked in lockstep, so the next tick happens at clk + 1
+        num_idle_cycles = std::min(num_idle_cycles, controller->get_next_event_clk() - (controller->get_clk() + 1));
+      }
+      return num_idle_cycles;
+    };
+
+    void fast_forward(Clk_t num_cycles) override {
+      m_clk += num_cycles;
+      m_dram->fast_forward(num_cycles);
+      for (auto controller : m_controllers) {
+        controller->fast_forward(num_cycles);
+      }
+    };
 };
   
 }   // namespace 
@@ -20,6 +20,7 @@ class IMemorySystem : public TopLevel<IMemorySystem> {
   protected:
     IFrontEnd* m_frontend;
     uint m_clock_ratio = 1;
+    bool m_fast_forward = false;
 
   public:
     virtual void connect_frontend(IFrontEnd* frontend) { 
@@ -51,6 +52,13 @@ class IMemorySystem : public TopLevel<IMemorySystem> {
      */
     virtual bool send(Request req) = 0;
 
+    /**
+     * @brief    Returns the channel that serves the request (maps its address if needed), or -1 if the memory
+     *           system does not have channels.
+     * 
+     */
+    virtual int get_channel_id(Request& req) { return -1; };
+
     /**
      * @brief         Ticks the memory system
      * 
@@ -74,6 +82,31 @@ class IMemorySystem : public TopLevel<IMemorySystem> {
 
     // jhpar: Add
     virtual bool is_pending() = 0;
+
+    /**
+     * @brief    Whether fast-forwarding over idle cycles is enabled for this memory system.
+     * 
+     */
+    bool is_fast_forward_enabled() { return m_fast_forward; };
+
+    /**
+     * @brief    Returns the number of upcoming cycles in which ticking the memory system would only advance its clock.
+     * 
+     */
+    virtual Clk_t get_num_idle_cycles() { return 0; };
+
+    /**
+     * @brief    Advances the memory system over the given number of idle cycles without ticking.
+     * 
+     */
+    virtual void fast_forward(Clk_t num_cycles) { };
+
+    /**
+     * @brief    Returns the number of cycles the memory system ran ahead on its own in its last tick (e.g., to drain
+     *           the requests once the frontend is finished). The frontend has to skip the same cycles.
+     * 
+     */
+    virtual Clk_t get_num_skipped_cycles() { return 0; };
 };
 
 }        // namespace Ramulator
@@ -0,0 +1,98 @@
+import argparse
+import struct
+from array import array
+
+## Converts a text PIM load/store trace (e.g., attacc_bg.trace) into the binary format that PIMLoadStoreTrace
+## replays from a memory-mapped file.
+##
+## ------|  header (32 bytes)                                                                      |------ ##
+##       | magic "PIMTRACE" (8) | version (u32) | #channels (u32) | #records (u64) | reserved (u64) |       ##
+## ------|  record (u64, little-endian), one per trace line                                        |------ ##
+##       | bits 0-7: request type | bits 8-63: signed address delta from the previous record       |       ##
+
+MAGIC = b"PIMTRACE"
+VERSION = 1
+HEADER = struct.Struct("<8sIIQQ")
+
+## Must match TRACE_OPCODES in src/frontend/trace_opcodes.h
+REQ_TYPES = {
+  "LD":             0,
+  "ST":             1,
+  "PIM_MAC_AB":     4,
+  "PIM_MAC_SB":     5,
+  "PIM_MAC_PB":     6,
+  "PIM_WR_GB":      7,
+  "PIM_MV_SB":      8,
+  "PIM_MV_GB":      9,
+  "PIM_SFM":       10,
+  "PIM_SET_MODEL": 11,
+  "PIM_SET_HEAD":  12,
+  "PIM_BARRIER":   13,
+}
+
+DELTA_MIN = -(1 << 55)
+DELTA_MAX = (1 << 55) - 1
+CHUNK_SIZE = 1 << 20
+
+
+def convert(input_path, output_path, n_channel):
+  n_record = 0
+  prev_addr = 0
+  records = array('Q')
+
+  with open(input_path, 'r') as trace_file, open(output_path, 'wb') as binary_file:
+    # The number of records is filled in once the whole trace has been converted
+    binary_file.write(HEADER.pack(MAGIC, VERSION, n_channel, 0, 0))
+
+    for line_no, line in enumerate(trace_file, 1):
+      tokens = line.split()
+      if len(tokens) != 2 or tokens[0] not in REQ_TYPES:
+        raise ValueError(f"{input_path}:{line_no}: invalid trace line '{line.rstrip()}'")
+
+      addr = int(tokens[1], 0) if tokens[1][:2].lower() == "0x" else int(tokens[1])
+      delta = addr - prev_addr
+      if delta < DELTA_MIN or delta > DELTA_MAX:
+        raise ValueError(f"{input_path}:{line_no}: address delta does not fit in 56 bits")
+      prev_addr = addr
+
+      records.append(((delta << 8) | REQ_TYPES[tokens[0]]) & 0xFFFFFFFFFFFFFFFF)
+      if len(records) == CHUNK_SIZE:
+        n_record += write_records(binary_file, records)
+
+    n_record += write_records(binary_file, records)
+
+    binary_file.seek(0)
+    binary_file.write(HEADER.pack(MAGIC, VERSION, n_channel, n_record, 0))
+
+  return n_record
+
+
+def write_records(binary_file, records):
+  n_record = len(records)
+  if struct.pack("=H", 1) != struct.pack("<H", 1):
+    records.byteswap()
+  records.tofile(binary_file)
+  del records[:]
+  return n_record
+
+
+def main():
+  parser = argparse.ArgumentParser(description="Convert a text PIM load/store trace into the binary trace format",
+                                   formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+
+  parser.add_argument("input", type=str,
+                      help="path to the text trace")
+  parser.add_argument("-o", "--output", type=str, default=None,
+                      help="path to the binary trace (default: input path with a .bin suffix)")
+  parser.add_argument("-ch", "--channel", type=int, default=0,
+                      help="number of channels the trace was generated for, checked against the memory system (0: unchecked)")
+
+  args = parser.parse_args()
+  output = args.output if args.output is not None else args.input + ".bin"
+
+  n_record = convert(args.input, output, args.channel)
+  print(f"Converted {n_record} records from {args.input} to {output}")
+
+
+if __name__ == "__main__":
+  main()
@@ -0,0 +1,54 @@
+import argparse
+import random
+
+## Generates a synthetic trace for OpenLoopTrace, i.e., requests annotated with the cycle at which they are injected.
+##
+## ------|  <cycle> <type> <address>  |------ ##
+##
+## The inter-arrival times are exponential (Poisson arrivals) or constant, and the addresses are uniformly random
+## and aligned to the access granularity. The injection rate can later be scaled with the rate_scale parameter of
+## OpenLoopTrace, so one trace is enough for a whole load-latency curve.
+
+
+def main():
+  parser = argparse.ArgumentParser(description="Generate a timestamped random read/write trace",
+                                   formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+
+  parser.add_argument("-n", "--nreq", type=int, default=100000,
+                      help="number of requests")
+  parser.add_argument("-i", "--interval", type=float, default=4.0,
+                      help="mean number of cycles between two requests")
+  parser.add_argument("-d", "--dist", type=str, default="poisson", choices=["poisson", "uniform"],
+                      help="inter-arrival time distribution")
+  parser.add_argument("-r", "--read", type=float, default=1.0,
+                      help="fraction of reads")
+  parser.add_argument("-a", "--maxaddr", type=int, default=pow(2, 31),
+                      help="size of the address space (B)")
+  parser.add_argument("-g", "--gran", type=int, default=32,
+                      help="access granularity (B)")
+  parser.add_argument("-s", "--seed", type=int, default=0,
+                      help="random seed")
+  parser.add_argument("-o", "--output", type=str, default="timed.trace",
+                      help="output path")
+
+  args = parser.parse_args()
+  rng = random.Random(args.seed)
+
+  cycle = 0.0
+  n_lines = args.maxaddr // args.gran
+  with open(args.output, 'w') as trace_file:
+    for _ in range(args.nreq):
+      req_type = "LD" if rng.random() < args.read else "ST"
+      addr = rng.randrange(n_lines) * args.gran
+      trace_file.write("{} {} 0x{:x}\n".format(int(cycle), req_type, addr))
+
+      if args.dist == "poisson":
+        cycle += rng.expovariate(1.0 / args.interval)
+      else:
+        cycle += args.interval
+
+  print(f"Generated {args.nreq} requests over {int(cycle)} cycles to {args.output}")
+
+
+if __name__ == "__main__":
+  main()